@@ -19,6 +19,9 @@ BuildRequires:  pkgconfig(dali2-adaptor)
 BuildRequires:  pkgconfig(dali2-toolkit)
 BuildRequires:  pkgconfig(libtzplatform-config)
 BuildRequires:  pkgconfig(glesv2)
+BuildRequires:  pkgconfig(egl)
+BuildRequires:  pkgconfig(dlog)
+BuildRequires:  pkgconfig(zlib)
 
 %description
 A simple DALi example with resources and a style.
@@ -0,0 +1,67 @@
+# Renderer core of dali-nativegl-library, included by its CMakeLists.txt and by
+# dali-glwindow-example so both run the same code. The sources are compiled once:
+#
+#   dali-nativegl-core-objects  position independent objects, for the shared library
+#   dali-nativegl-core          static library of the same objects, for executables
+#
+# Symbols are hidden except the EXPORT_API functions. With ENABLE_LTO (default) and a compiler
+# that supports it the objects carry intermediate code only, so a target linking
+# dali-nativegl-core sets INTERPROCEDURAL_OPTIMIZATION to ${DALI_NATIVEGL_CORE_LTO} too.
+#
+# ENABLE_TRACING records spans and counters on init, render, input and resize, see dumpTrace();
+# compiled out by default.
+
+SET(DALI_NATIVEGL_CORE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+SET(DALI_NATIVEGL_CORE_SOURCES ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-matrix.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-camera.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-mesh.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-state.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-program.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-input.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-trace.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-timing.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-cull.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-jobs.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-stream.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-capture.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-image.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-resource.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-snapshot.c
+                               ${DALI_NATIVEGL_CORE_DIR}/src/dali-nativegl-hash.c)
+
+INCLUDE(FindPkgConfig)
+pkg_check_modules(dali-nativegl-core REQUIRED dlog glesv2 egl zlib)
+
+OPTION(ENABLE_LTO "Link-time optimization of the dali-nativegl renderer core" ON)
+SET(DALI_NATIVEGL_CORE_LTO OFF)
+IF(ENABLE_LTO)
+    INCLUDE(CheckIPOSupported)
+    CHECK_IPO_SUPPORTED(RESULT DALI_NATIVEGL_CORE_LTO OUTPUT lto_output LANGUAGES C)
+    IF(NOT DALI_NATIVEGL_CORE_LTO)
+        MESSAGE(STATUS "dali-nativegl-core: link-time optimization not supported")
+    ENDIF(NOT DALI_NATIVEGL_CORE_LTO)
+ENDIF(ENABLE_LTO)
+
+OPTION(ENABLE_TRACING "Record a Chrome trace in the dali-nativegl renderer core" OFF)
+
+ADD_LIBRARY(dali-nativegl-core-objects OBJECT ${DALI_NATIVEGL_CORE_SOURCES})
+TARGET_INCLUDE_DIRECTORIES(dali-nativegl-core-objects PRIVATE ${DALI_NATIVEGL_CORE_DIR}/include ${dali-nativegl-core_INCLUDE_DIRS})
+TARGET_COMPILE_OPTIONS(dali-nativegl-core-objects PRIVATE ${dali-nativegl-core_CFLAGS_OTHER} -fvisibility=hidden)
+IF(ENABLE_TRACING)
+    TARGET_COMPILE_DEFINITIONS(dali-nativegl-core-objects PRIVATE NATIVEGL_TRACE)
+ENDIF(ENABLE_TRACING)
+SET_TARGET_PROPERTIES(dali-nativegl-core-objects
+     PROPERTIES
+     POSITION_INDEPENDENT_CODE ON
+     INTERPROCEDURAL_OPTIMIZATION ${DALI_NATIVEGL_CORE_LTO}
+)
+
+ADD_LIBRARY(dali-nativegl-core STATIC $<TARGET_OBJECTS:dali-nativegl-core-objects>)
+TARGET_INCLUDE_DIRECTORIES(dali-nativegl-core PUBLIC ${DALI_NATIVEGL_CORE_DIR}/include ${dali-nativegl-core_INCLUDE_DIRS})
+TARGET_LINK_LIBRARIES(dali-nativegl-core PUBLIC ${dali-nativegl-core_LDFLAGS} m pthread)
+SET_TARGET_PROPERTIES(dali-nativegl-core
+     PROPERTIES
+     INTERPROCEDURAL_OPTIMIZATION ${DALI_NATIVEGL_CORE_LTO}
+)
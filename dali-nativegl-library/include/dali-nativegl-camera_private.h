@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __DALI_NATIVEGL_CAMERA_PRIVATE_H__
+#define __DALI_NATIVEGL_CAMERA_PRIVATE_H__
+
+#include <GLES2/gl2.h>
+#include <dali-nativegl-library_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Orbit camera with cached matrices. Setters only clear the valid flags, the matrices are
+ * recomputed by camera_update() when a frame needs them, and an unchanged camera costs a
+ * few compares per frame.
+ */
+
+/*
+ * @ brief View-projection for a width x height window drawn pre-rotated by angle onto its surface.
+ * @ details Recomputes the projection when the window, the angle or the projection settings
+ *           changed and the view when the camera moved; version changes with the result.
+ * @ return The cached view-projection.
+ */
+const float* camera_update(GLCamera* camera, int width, int height, int angle);
+
+/*
+ * @ brief Move the camera with its controller by a touch drag of dx, dy window pixels.
+ * @ param[in] shortSide Short side of the window in pixels, scales a pan to follow the finger.
+ * @ return 1 when the camera moved, 0 when the controller is GL_CAMERA_CONTROL_MODEL.
+ */
+int camera_drag(GLCamera* camera, float dx, float dy, int shortSide);
+
+/*
+ * @ brief Back to the initial orbit, target and zoom, the projection and controller are kept.
+ */
+void camera_reset(GLCamera* camera);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_CAMERA_PRIVATE_H__ */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_CAPTURE_PRIVATE_H__
+#define __DALI_NATIVEGL_CAPTURE_PRIVATE_H__
+
+#include <dali-nativegl-library_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Offscreen target and frame readback. On GLES3 a captured frame is copied into a pixel buffer
+ * object and fenced; later frames map it once the fence is signaled, so reading a frame never
+ * waits for the GPU to finish drawing it. Pixels then go to the image writer thread.
+ * capture_set_target() and capture_request() may be called from any thread, the rest only
+ * from the render thread.
+ */
+
+/*
+ * @ brief Request an offscreen size for the next frames, 0 renders to the window surface.
+ * @ return 1 when the size changed.
+ */
+int capture_set_target(GLCapture* capture, int width, int height);
+
+/*
+ * @ brief Capture the next drawn frame into path, replacing a request no frame has taken yet.
+ * @ param[in] format GLCaptureFormat.
+ * @ return 1 on success, 0 when out of memory.
+ */
+int capture_request(GLCapture* capture, const char* path, int format);
+
+/*
+ * @ brief Take the pending capture request and bind the offscreen target for this frame,
+ *         (re)creating it when the requested size changed, or the window surface when none is requested.
+ * @ return 1 when the frame is drawn offscreen, 0 for the window surface.
+ */
+int capture_begin_frame(GLCapture* capture, GLResourceRegistry* resources);
+
+/*
+ * @ brief Read back the drawn frame when a capture was requested, then bind the window surface.
+ * @ param[in] width, height Size of the drawn frame.
+ */
+void capture_end_frame(GLCapture* capture, GLResourceRegistry* resources, int glesVersion, int width, int height);
+
+/*
+ * @ brief Hand the finished readbacks to the writer thread.
+ * @ param[in] wait Also wait for the readbacks still in flight.
+ */
+void capture_poll(GLCapture* capture, int wait);
+
+/*
+ * @ brief Delete the GL objects, on the context they were created with. Readbacks in flight are dropped.
+ * @ param[in] contextLost The context is gone, only forget the fences.
+ */
+void capture_terminate(GLCapture* capture, GLResourceRegistry* resources, int contextLost);
+
+/*
+ * @ brief Wait until the readbacks are done and their files written.
+ * @ return The number of frames lost since the last call.
+ */
+int capture_flush(GLCapture* capture);
+
+/*
+ * @ brief Free the requests, after waiting for the writes still queued; the GL objects must be released.
+ */
+void capture_destroy(GLCapture* capture);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_CAPTURE_PRIVATE_H__ */
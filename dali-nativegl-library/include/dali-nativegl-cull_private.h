@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_CULL_PRIVATE_H__
+#define __DALI_NATIVEGL_CULL_PRIVATE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Bounding volume hierarchy over axis aligned boxes, culled against the view volume of a
+ * clip matrix. A box is 6 floats: min x, y, z then max x, y, z.
+ *
+ * Moving objects only refits the boxes of the existing tree on the next query; the tree is
+ * rebuilt when refitting has made it much looser than when it was built.
+ */
+typedef struct CullTree CullTree;
+
+/*
+ * @ brief Build a tree over count boxes, the boxes are copied.
+ * @ return The tree, or NULL when out of memory.
+ */
+CullTree* cull_tree_create(const float* boxes, int count);
+
+void cull_tree_destroy(CullTree* tree);
+
+/*
+ * @ brief Number of objects in the tree.
+ */
+int cull_tree_count(const CullTree* tree);
+
+/*
+ * @ brief Replace the box of object index, applied by the next query.
+ */
+void cull_tree_update(CullTree* tree, int index, const float box[6]);
+
+/*
+ * @ brief Find the objects whose box intersects the view volume of clip.
+ * @ param[in]  clip    Column-major matrix from object space to clip space.
+ * @ param[out] visible Indices of the visible objects in tree order, room for all objects.
+ * @ return The number of visible objects.
+ */
+int cull_tree_query(CullTree* tree, const float clip[16], int* visible);
+
+/*
+ * @ brief Split the tree into subtrees for a parallel query, applying pending updates first.
+ * @ param[out] roots  Subtrees covering all objects, in tree order, at most maxRoots.
+ * @ param[out] firsts Position of the first object of each subtree in tree order; the visible
+ *                     objects of a subtree fit from there up to the next subtree's position.
+ * @ return The number of subtrees.
+ */
+int cull_tree_split(CullTree* tree, int maxRoots, int* roots, int* firsts);
+
+/*
+ * @ brief cull_tree_query restricted to a subtree from cull_tree_split.
+ * @ details Does not modify the tree, subtrees may be queried concurrently until the next
+ *           update or query.
+ */
+int cull_tree_query_subtree(const CullTree* tree, int root, const float clip[16], int* visible);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_CULL_PRIVATE_H__ */
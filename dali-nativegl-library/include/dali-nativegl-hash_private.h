@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __DALI_NATIVEGL_HASH_PRIVATE_H__
+#define __DALI_NATIVEGL_HASH_PRIVATE_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * FNV-1a 64 hashing for the keys of cached GL data, which must miss whenever the driver or
+ * anything the data was built from changes.
+ */
+
+#define HASH_SEED 14695981039346656037ull
+
+/*
+ * @ brief Hash the string including its terminator into hash, NULL hashes like "".
+ */
+uint64_t hash_string(uint64_t hash, const char* value);
+
+/*
+ * @ brief Hash the vendor, renderer and version strings of the current context into hash.
+ */
+uint64_t hash_driver(uint64_t hash);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_HASH_PRIVATE_H__ */
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_IMAGE_PRIVATE_H__
+#define __DALI_NATIVEGL_IMAGE_PRIVATE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Image files of captured frames. Pixels are RGBA bytes as glReadPixels returns them, bottom
+ * row first; files store the top row first.
+ */
+
+/* Queued writes of one owner, updated by the writer thread under its lock */
+typedef struct {
+    int pending;                 /* Queued and not written yet */
+    int failed;                  /* Not written, or dropped by a full queue, since the last wait */
+} ImageWriteStatus;
+
+/*
+ * @ brief Write an image file now.
+ * @ param[in] format GLCaptureFormat.
+ * @ return 1 on success, 0 when the file cannot be written.
+ */
+int image_write(const char* path, int format, const unsigned char* pixels, int width, int height);
+
+/*
+ * @ brief Write an image file on the background writer thread, started on first use.
+ * @ details Takes ownership of path and pixels (malloc'ed), also when it fails. The queue is
+ *          bounded, a write finding it full is dropped.
+ * @ param[in] status Counts the write until it is done, must outlive it.
+ * @ return 1 when queued, 0 when dropped or the thread cannot be started (counted as failed).
+ */
+int image_queue_write(ImageWriteStatus* status, char* path, int format, unsigned char* pixels, int width, int height);
+
+/*
+ * @ brief Wait until the writes queued with status are written.
+ * @ return The number of them that could not be written since the last call.
+ */
+int image_wait_writes(ImageWriteStatus* status);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_IMAGE_PRIVATE_H__ */
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_INPUT_PRIVATE_H__
+#define __DALI_NATIVEGL_INPUT_PRIVATE_H__
+
+#include <GLES2/gl2.h>
+#include <dali-nativegl-library_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* GLInputEvent::type */
+typedef enum {
+    INPUT_EVENT_TOUCH_DOWN = 0,
+    INPUT_EVENT_TOUCH_UP,
+    INPUT_EVENT_MOTION,          /* x, y: touch position */
+    INPUT_EVENT_ROTATE           /* x, y: rotation delta in degrees */
+} InputEventType;
+
+/*
+ * @ brief Queue an event stamped with input_time_ms(), producer side. Lock free, never blocks.
+ * @ details Motion and rotation leave GL_INPUT_QUEUE_RESERVED slots free for touch down and up.
+ *          A touch down or up finding even those full is kept aside and popped in its place,
+ *          after the events queued before it, so the touch state is never lost.
+ * @ return 1 when queued, 0 when the ring is full and the event was dropped or kept aside.
+ */
+int input_queue_push(GLInputQueue* queue, InputEventType type, int x, int y);
+
+/*
+ * @ brief Take the oldest event, consumer side, the touch down or up kept aside included.
+ * @ return 1 when an event was taken, 0 when there is none.
+ */
+int input_queue_pop(GLInputQueue* queue, GLInputEvent* event);
+
+/*
+ * @ brief Events dropped so far, may be read from any thread.
+ */
+unsigned int input_queue_dropped(GLInputQueue* queue);
+
+/*
+ * @ brief CLOCK_MONOTONIC in milliseconds, the time base of GLInputEvent::time.
+ */
+double input_time_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_INPUT_PRIVATE_H__ */
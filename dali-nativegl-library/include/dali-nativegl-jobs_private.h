@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_JOBS_PRIVATE_H__
+#define __DALI_NATIVEGL_JOBS_PRIVATE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Work stealing thread pool for data parallel loops. Every thread owns a deque of index
+ * ranges: it splits its range in halves, pushing the upper halves where idle threads steal
+ * them, and works on the lower half itself. The calling thread takes part in the loop, and
+ * threads with nothing to steal sleep until ranges are pushed or the loop is finished.
+ * Every instance has its own pool, used only from its render thread.
+ */
+
+typedef struct JobPool JobPool;
+
+/*
+ * @ brief Loop body, called for disjoint [begin, end) ranges, possibly on several threads.
+ */
+typedef void (*JobFunction)(void* data, int begin, int end);
+
+/*
+ * @ brief Number of worker threads of every pool.
+ * @ param[in] count Threads besides the caller; -1 starts one per additional core, 0 runs
+ *                   loops on the calling thread only.
+ * @ details May be called from any thread. Pools restart their workers before their next loop.
+ * @ return 1 on success, 0 when count is out of range.
+ */
+int jobs_set_worker_count(int count);
+
+/*
+ * @ brief Number of worker threads besides the caller.
+ * @ param[in,out] pool Created, and its workers started, when needed.
+ */
+int jobs_worker_count(JobPool** pool);
+
+/*
+ * @ brief Call function for every index in [0, count) and wait until all of them returned.
+ * @ param[in,out] pool Created, and its workers started, when needed.
+ * @ param[in] grain Ranges are not split below this many indices.
+ */
+void jobs_parallel_for(JobPool** pool, JobFunction function, void* data, int count, int grain);
+
+/*
+ * @ brief Stop and join the workers and free the pool.
+ */
+void jobs_destroy(JobPool** pool);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_JOBS_PRIVATE_H__ */
@@ -17,6 +17,7 @@
 #ifndef __DALI_NATIVEGL_LIBRARY_UTIL_H__
 #define __DALI_NATIVEGL_LIBRARY_UTIL_H__
 
+#include <stddef.h>
 #include <tizen.h>
 
 #ifdef __cplusplus
@@ -37,31 +38,387 @@ typedef struct {
     float x, y;
 } FloatPoint;
 
-/* Application data */
-typedef struct GLDATA {
-    float model[16];
-    float view[16];
-    float mvp[16];
+/* GL calls counted by the state cache, see getGLStateCounters() */
+typedef struct {
+    unsigned int issued;         /* State changes passed on to GL */
+    unsigned int skipped;        /* Redundant state changes filtered out */
+    unsigned int drawCalls;
+    unsigned int frames;         /* Frames rendered */
+    unsigned int idleFrames;     /* Frames skipped by render on demand */
+    unsigned int inputEvents;    /* Input events applied */
+    unsigned int visibleObjects; /* Field instances inside the view volume */
+    unsigned int culledObjects;  /* Field instances skipped by frustum culling */
+    unsigned int streamStalls;   /* Streaming buffer regions still read by the GPU when rewritten */
+} GLStateCounters;
+
+/* Timed parts of renderFrameGL(), see getFrameTimingStats() */
+typedef enum {
+    GL_TIMING_CPU_INPUT = 0,     /* Draining and applying the input queue */
+    GL_TIMING_CPU_RENDER,        /* Matrices, state and draw submission of a drawn frame */
+    GL_TIMING_GPU_RENDER,        /* GPU execution of the same commands, GL_EXT_disjoint_timer_query */
+    GL_TIMING_PASS_COUNT
+} GLTimingPass;
+
+#define GL_TIMING_WINDOW 256     /* Samples kept per pass */
+#define GL_TIMING_BUCKETS 12     /* Histogram buckets, see GLTimingStats */
+
+/* Statistics over the last GL_TIMING_WINDOW samples of a pass, in milliseconds */
+typedef struct {
+    unsigned int samples;
+    float        mean;
+    float        p50;
+    float        p95;
+    float        p99;
+    float        max;
+    /* histogram[0] counts samples below 0.125 ms, each next bucket doubles the bound,
+       the last one counts everything from 128 ms */
+    unsigned int histogram[GL_TIMING_BUCKETS];
+} GLTimingStats;
+
+/* File formats of captured frames, see requestFrameCapture() */
+typedef enum {
+    GL_CAPTURE_RAW = 0,          /* RGBA bytes, top row first, no header */
+    GL_CAPTURE_PNG
+} GLCaptureFormat;
+
+/* Kinds of GL objects the renderer creates, see getGLResourceStats() */
+typedef enum {
+    GL_RESOURCE_PROGRAM = 0,
+    GL_RESOURCE_SHADER,
+    GL_RESOURCE_BUFFER,
+    GL_RESOURCE_TEXTURE,
+    GL_RESOURCE_RENDERBUFFER,
+    GL_RESOURCE_FRAMEBUFFER,
+    GL_RESOURCE_KIND_COUNT
+} GLResourceKind;
+
+/* GL objects of an instance */
+typedef struct {
+    unsigned int live[GL_RESOURCE_KIND_COUNT];
+    size_t       bytes[GL_RESOURCE_KIND_COUNT];   /* Storage of the live objects as uploaded, without driver overhead */
+    unsigned int created;        /* Objects created over the lifetime of the instance */
+    unsigned int deleted;
+    unsigned int reclaimed;      /* Objects terminateGL() found still alive after releasing everything it knows */
+    unsigned int lost;           /* Objects that went away with a lost context */
+    size_t       snapshotBytes;  /* CPU-side copy kept to restore a lost context */
+} GLResourceStats;
+
+/* Projections of the camera, see setCameraProjection() */
+typedef enum {
+    GL_CAMERA_ORTHOGRAPHIC = 0,  /* [-1, 1] across the short side of the window */
+    GL_CAMERA_PERSPECTIVE
+} GLCameraProjection;
+
+/* What a touch drag does, see setCameraController() */
+typedef enum {
+    GL_CAMERA_CONTROL_MODEL = 0, /* Rotate the cube */
+    GL_CAMERA_CONTROL_ORBIT,     /* Orbit the camera around its target */
+    GL_CAMERA_CONTROL_PAN,       /* Move the camera and its target along the view plane */
+    GL_CAMERA_CONTROL_ZOOM       /* Dragging up zooms in, down zooms out */
+} GLCameraController;
+
+/* Application data, private to the library */
+typedef struct GLDATA GLData;
+
+/**
+ * @brief Create an independent scene instance.
+ * @details The entry points without a GLData argument operate on a built-in default instance.
+ *          GL objects of an instance belong to the context current at intializeGLInstance().
+ * @return A zero initialized instance, or NULL when out of memory.
+ */
+GLData* createGLInstance(void);
+
+/**
+ * @brief Free an instance created by createGLInstance(), call terminateGLInstance() first.
+ */
+void destroyGLInstance(GLData* glData);
+
+/**
+ * @brief Draw a field of count cubes instead of the single cube.
+ * @details Uses instanced drawing with per-instance matrices on GLES3 and batches of
+ *          uniform matrices on GLES2. A count of 1 restores the single cube.
+ * @return 1 on success, 0 when the per-instance data could not be allocated.
+ */
+int setInstanceCount(int count);
+int setInstanceCountInstance(GLData* glData, int count);
+
+/**
+ * @brief Move one cube of the field, replacing its place in the default layout.
+ * @details The view volume spans [-1, 1] vertically and the aspect ratio horizontally; cubes
+ *          outside of it are culled before drawing. Call after setInstanceCount().
+ * @param[in] scale Edge length of the cube.
+ * @return 1 on success, 0 when index is not a cube of the field.
+ */
+int setInstanceTransform(int index, float x, float y, float z, float scale);
+int setInstanceTransformInstance(GLData* glData, int index, float x, float y, float z, float scale);
+
+/**
+ * @brief Skip the cubes of the field that are outside the view volume, on by default.
+ */
+void setFrustumCulling(bool enable);
+void setFrustumCullingInstance(GLData* glData, bool enable);
+
+/**
+ * @brief Threads that cull the cube field and compute its matrices with the render thread.
+ * @details Applies to all instances, each of which runs its own threads from its first culled
+ *          or instanced frame until terminateGL(); a change restarts them before the next frame.
+ *          -1 (the default) starts one per additional core, 0 keeps the scene update on the
+ *          render thread. The GL calls stay on the render thread. May be called from any thread.
+ * @return 1 on success, 0 when count is below -1 or above 63.
+ */
+int setWorkerThreadCount(int count);
+
+/**
+ * @brief Draw the mesh of a binary mesh file instead of the cube.
+ * @details The file is memory mapped and uploaded as is at the next intializeGL(), files are
+ *          written by dali-nativegl-mesh-converter. The cube is drawn when the file cannot be
+ *          used with the current context. NULL restores the cube.
+ * @return 1 on success, 0 when out of memory.
+ */
+int setMeshFile(const char* path);
+int setMeshFileInstance(GLData* glData, const char* path);
+
+/**
+ * @brief Only render when the scene changed since the last rendered frame.
+ * @details The update functions mark the scene dirty when they change something; an idle
+ *          renderFrameGL() draws nothing and returns 0 so the window keeps the last frame.
+ *          Off by default, every frame is rendered.
+ */
+void setRenderOnDemand(bool enable);
+void setRenderOnDemandInstance(GLData* glData, bool enable);
 
-    FloatPoint anglePoint;
-    FloatPoint curPoint;
-    FloatPoint prevPoint;
+/**
+ * @brief Render the next frame even when nothing changed, e.g. after the window was exposed.
+ */
+void requestRender(void);
+void requestRenderInstance(GLData* glData);
 
-    GLuint       vtx_shader;
-    GLuint       fgmt_shader;
-    /*A program object is an object to which shader objects can be attached*/
-    unsigned int program;
+/**
+ * @brief Extrapolate touch drags to the time the frame reaches the screen.
+ * @details Motion events queued since the last frame are always applied as one delta. With a
+ *          lead time the rotation is also advanced along the drag velocity, by the age of the
+ *          newest sample plus leadMs (at most 50 ms), which hides the input to display latency.
+ *          The prediction is never accumulated; it is dropped when the touch is released or
+ *          the finger rests. 0 disables prediction, the default.
+ */
+void setInputPrediction(float leadMs);
+void setInputPredictionInstance(GLData* glData, float leadMs);
 
-    /* Generate Vertex Buffer */
-    unsigned int vbo;
+/**
+ * @brief Measure the CPU and GPU time of every frame, off by default.
+ * @details GPU times need GL_EXT_disjoint_timer_query; the queries are read back a few frames
+ *          later so the CPU never waits for the GPU. Without the extension only the CPU passes
+ *          are measured.
+ */
+void setFrameTimingEnabled(bool enable);
+void setFrameTimingEnabledInstance(GLData* glData, bool enable);
 
-    int width;
-    int height;
+/**
+ * @brief Statistics of one pass over the most recent frames.
+ * @return 1 when stats was filled, 0 when the pass has no samples (e.g. no GPU timer support).
+ */
+int getFrameTimingStats(GLTimingPass pass, GLTimingStats* stats);
+int getFrameTimingStatsInstance(GLData* glData, GLTimingPass pass, GLTimingStats* stats);
 
-    bool mouse_down;
+/**
+ * @brief Render into an offscreen texture of width x height instead of the window surface.
+ * @details The target is created by the next renderFrameGL(), which returns 0 while it is set
+ *          as there is nothing to present. The projection follows the target size, without the
+ *          window rotation. 0 x 0 renders to the window surface again. May be called from
+ *          any thread.
+ */
+void setOffscreenTarget(int width, int height);
+void setOffscreenTargetInstance(GLData* glData, int width, int height);
 
-    int windowAngle;
-} GLData;
+/**
+ * @brief Texture holding the last offscreen frame, e.g. for a thumbnail; 0 without a target.
+ */
+unsigned int getOffscreenTexture(void);
+unsigned int getOffscreenTextureInstance(GLData* glData);
+
+/**
+ * @brief Write the next drawn frame to path, from the offscreen target when one is set.
+ * @details GLES3 copies the frame into a pixel buffer object and maps it once a fence says the
+ *          copy is done, a few frames later; GLES2 reads it synchronously. The file is written
+ *          on a background thread. A request replaces the previous one until a frame is drawn.
+ *          May be called from any thread.
+ * @return 1 on success, 0 when out of memory.
+ */
+int requestFrameCapture(const char* path, GLCaptureFormat format);
+int requestFrameCaptureInstance(GLData* glData, const char* path, GLCaptureFormat format);
+
+/**
+ * @brief Wait until the captured frames are written, with the instance's context current.
+ * @details Call before terminateGL(), which drops the captures still being read back. Frames
+ *          reaching the writer while it is several frames behind are dropped, not queued.
+ * @return The number of frames of this instance that could not be written since the last call.
+ */
+int flushFrameCaptures(void);
+int flushFrameCapturesInstance(GLData* glData);
+
+/**
+ * @brief Write the recorded trace (init, render, input, resize) as Chrome trace JSON.
+ * @details The file opens in chrome://tracing or ui.perfetto.dev. Tracing is compiled in with
+ *          -DENABLE_TRACING=ON; otherwise nothing is recorded and this returns 0.
+ * @return 1 on success, 0 on failure or when tracing is not compiled in.
+ */
+int dumpTrace(const char* path);
+
+/**
+ * @brief Discard the events recorded so far, e.g. after warming up.
+ */
+void resetTrace(void);
+
+/**
+ * @brief Store linked shader programs in directory and load them from there on later runs.
+ * @details Uses program binaries, so GLES3 only. Entries are keyed by the shader sources and
+ *          the driver's vendor, renderer and version, a changed shader or driver just misses.
+ *          Shared by all instances, set it before intializeGL(). NULL disables the cache.
+ * @return 1 on success, 0 when out of memory.
+ */
+int setProgramCacheDirectory(const char* directory);
+
+/**
+ * @brief Number of input events dropped because the queue was full (the renderer stalled).
+ * @details Only motion and rotation are dropped, touch down and up always reach the renderer.
+ */
+unsigned int getDroppedInputEvents(void);
+unsigned int getDroppedInputEventsInstance(GLData* glData);
+
+/**
+ * @brief Read the state cache counters accumulated since the last reset.
+ * @details Every frame the renderer only passes state changes to GL that differ from the
+ *          last value it set; issued + skipped is what it would have called without the cache.
+ */
+void getGLStateCounters(GLStateCounters* counters);
+void getGLStateCountersInstance(GLData* glData, GLStateCounters* counters);
+
+/**
+ * @brief Count and size of the GL objects the instance owns, by kind.
+ * @details After terminateGL() every live count is 0; intializeGL() on an initialized instance
+ *          releases the previous objects first, so repeated initialization does not add up.
+ *          snapshotBytes is the CPU memory kept for notifyGLContextLost().
+ */
+void getGLResourceStats(GLResourceStats* stats);
+void getGLResourceStatsInstance(GLData* glData, GLResourceStats* stats);
+
+/**
+ * @brief Project the scene orthographically (the default) or in perspective.
+ * @param[in] fovY Perspective field of view across the short side of the window in degrees,
+ *                 0 for 45. Both projections show [-1, 1] across the short side at the target.
+ */
+void setCameraProjection(GLCameraProjection projection, float fovY);
+void setCameraProjectionInstance(GLData* glData, GLCameraProjection projection, float fovY);
+
+/**
+ * @brief Choose what touch drags do: rotate the cube (the default), or orbit, pan or zoom the
+ *        camera. rotationCube() always rotates the cube.
+ */
+void setCameraController(GLCameraController controller);
+void setCameraControllerInstance(GLData* glData, GLCameraController controller);
+
+/**
+ * @brief How touch drags rotate the cube under GL_CAMERA_CONTROL_MODEL.
+ * @details By default a horizontal drag turns it around its vertical axis and a vertical drag
+ *          tips it towards the viewer, one degree per pixel. With arcball enabled the cube follows
+ *          the finger on a sphere inscribed in the window, so a circling drag rolls it.
+ */
+void setArcballRotation(bool enable);
+void setArcballRotationInstance(GLData* glData, bool enable);
+
+/**
+ * @brief Move the camera back to its initial orbit, target and zoom, as intializeGL() does.
+ */
+void resetCamera(void);
+void resetCameraInstance(GLData* glData);
+
+/**
+ * @brief Matrices of the last drawn frame, column-major. Any argument may be NULL.
+ * @return 1 on success, 0 when no frame was drawn yet.
+ */
+int getCameraMatrices(float view[16], float projection[16], float viewProjection[16]);
+int getCameraMatricesInstance(GLData* glData, float view[16], float projection[16], float viewProjection[16]);
+
+/**
+ * @brief The instance's context was lost, e.g. eglSwapBuffers() failed with EGL_CONTEXT_LOST.
+ * @details Its GL objects went away with the context and are forgotten without calling GL. The
+ *          next intializeGL() loads the program binaries kept from the previous initialization
+ *          instead of compiling them again, maps the mesh file again and keeps the view.
+ *          Call on the render thread; nothing happens when the instance is not initialized.
+ */
+void notifyGLContextLost(void);
+void notifyGLContextLostInstance(GLData* glData);
+
+/**
+ * @brief Reset the state cache counters to zero.
+ */
+void resetGLStateCounters(void);
+void resetGLStateCountersInstance(GLData* glData);
+
+/**
+ * @brief Forget the cached GL state, call when other code changed it in the same context
+ *        (e.g. another instance or the host's own rendering) before the next renderFrameGL().
+ */
+void invalidateGLState(void);
+void invalidateGLStateInstance(GLData* glData);
+
+/**
+ * @brief Per-instance variants of the entry points below.
+ */
+void intializeGLInstance(GLData* glData);
+int renderFrameGLInstance(GLData* glData);
+void terminateGLInstance(GLData* glData);
+void updateTouchEventStateInstance(GLData* glData, bool down);
+void updateTouchPositionInstance(GLData* glData, int x, int y);
+void rotationCubeInstance(GLData* glData, int x, int y);
+void updateWindowSizeInstance(GLData* glData, int w, int h);
+void updateWindowRotationAngleInstance(GLData* glData, int angle);
+
+/**
+ * @brief Initialize the GL resources, called once when the GL context is ready.
+ * @details Called again without terminateGL() or after notifyGLContextLost(), it restores the
+ *          scene as it was drawn last.
+ */
+void intializeGL(void);
+
+/**
+ * @brief Render one frame.
+ * @return 1 when the frame should be swapped, 0 when nothing was drawn.
+ */
+int renderFrameGL(void);
+
+/**
+ * @brief Release the GL resources, called when the GL context is destroyed.
+ */
+void terminateGL(void);
+
+/**
+ * @brief Update the touch (mouse) pressed state.
+ * @details The touch and rotation functions may be called from one thread other than the
+ *          render thread; the events are queued without locking and applied together at the
+ *          start of the next renderFrameGL().
+ */
+void updateTouchEventState(bool down);
+
+/**
+ * @brief Update the touch position, rotates the cube while the touch is pressed.
+ */
+void updateTouchPosition(int x, int y);
+
+/**
+ * @brief Rotate the cube by the given delta.
+ */
+void rotationCube(int x, int y);
+
+/**
+ * @brief Update the window size used for the viewport and projection.
+ */
+void updateWindowSize(int w, int h);
+
+/**
+ * @brief Update the window rotation angle (0, 90, 180 or 270).
+ */
+void updateWindowRotationAngle(int angle);
 
 /**
  * @}
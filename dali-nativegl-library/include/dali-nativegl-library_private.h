@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_LIBRARY_PRIVATE_H__
+#define __DALI_NATIVEGL_LIBRARY_PRIVATE_H__
+
+#include <GLES2/gl2.h>
+#include <dali-nativegl-library.h>
+#include <dali-nativegl-image_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Definition of GLData and the state it is made of, shared by the renderer's modules.
+ * Applications only see GLData as an opaque instance.
+ */
+
+/* Bounding volume hierarchy of the field, see dali-nativegl-cull_private.h */
+struct CullTree;
+
+/* Thread pool of the scene update, see dali-nativegl-jobs_private.h */
+struct JobPool;
+
+#define GL_STATE_MAX_ATTRIBS 8
+
+/* Last vertex attribute setup passed to GL */
+typedef struct {
+    unsigned int validMask;      /* Which of the fields below match GL */
+    unsigned int buffer;
+    int          size;
+    unsigned int type;
+    int          normalized;
+    int          stride;
+    const void*  offset;
+    int          enabled;
+    unsigned int divisor;
+} GLAttribState;
+
+/* Shadow of the GL state the renderer changes, redundant changes are skipped */
+typedef struct {
+    unsigned int validMask;      /* Which of the fields below match GL */
+    unsigned int program;
+    unsigned int arrayBuffer;
+    unsigned int elementArrayBuffer;
+    int          viewport[4];
+    float        clearColor[4];
+    int          depthTest;
+    GLAttribState attribs[GL_STATE_MAX_ATTRIBS];
+    GLStateCounters counters;
+} GLStateCache;
+
+#define GL_INPUT_QUEUE_SIZE 256
+#define GL_INPUT_QUEUE_RESERVED 16   /* Slots only touch down and up may fill */
+
+/* Input event, queued by the update functions and applied by the render thread */
+typedef struct {
+    int type;
+    int x, y;
+    double time;                 /* CLOCK_MONOTONIC milliseconds, stamped when queued */
+} GLInputEvent;
+
+/* Single producer / single consumer ring, head and tail on separate cache lines */
+typedef struct {
+    unsigned int head;           /* Next slot to write, only written by the producer */
+    char         headPadding[60];
+    unsigned int tail;           /* Next slot to read, only written by the consumer */
+    char         tailPadding[60];
+    unsigned int dropped;        /* Motion and rotation events lost while the ring was full */
+    /* Last touch down or up that found the ring full, or 0: (type + 1) << 32 | head at the time,
+     * the position where the consumer takes it */
+    unsigned long long lostTouch;
+    GLInputEvent events[GL_INPUT_QUEUE_SIZE];
+} GLInputQueue;
+
+#define GL_TIMING_QUERIES 4      /* GPU queries in flight, results are read a few frames late */
+
+/* Rolling CPU and GPU frame timings */
+typedef struct {
+    bool         enabled;
+    int          gpuSupported;   /* 0 until checked on the current context, then 1 or -1 */
+    unsigned int queries[GL_TIMING_QUERIES];
+    unsigned int queryHead;      /* Queries issued */
+    unsigned int queryTail;      /* Queries whose result was read */
+    float        samples[GL_TIMING_PASS_COUNT][GL_TIMING_WINDOW];
+    unsigned int sampleCount[GL_TIMING_PASS_COUNT];
+} GLFrameTiming;
+
+#define GL_STREAM_REGIONS 3      /* Frames a streaming buffer may have in flight */
+
+/* Buffer rewritten every frame without waiting for the GPU to finish reading the previous data */
+typedef struct {
+    unsigned int buffer;
+    int          mapped;         /* GLES3: unsynchronized ranges of a region ring, guarded by fences */
+    int          regionSize;     /* Bytes per region */
+    int          region;         /* Region written this frame */
+    int          size;           /* Bytes written this frame */
+    void*        fences[GL_STREAM_REGIONS];   /* GLsync after the last draw reading each region */
+    void*        staging;        /* Orphaning: regionSize bytes uploaded into fresh storage every frame */
+} GLStreamBuffer;
+
+#define GL_CAPTURE_SLOTS 3       /* Readbacks in flight */
+
+/* Readback of a captured frame */
+typedef struct {
+    unsigned int pbo;            /* GLES3: pixel pack buffer the frame is copied into */
+    int          pboSize;
+    void*        fence;          /* GLsync after the copy, NULL when the slot is free */
+    char*        path;
+    int          format;
+    int          width;
+    int          height;
+} GLCaptureSlot;
+
+/* Capture requested by requestFrameCapture() */
+typedef struct {
+    char*        path;
+    int          format;
+} GLCaptureRequest;
+
+/* Offscreen render target and frame captures. Other threads only swap targetSize and request,
+ * everything else belongs to the render thread. */
+typedef struct {
+    unsigned long long targetSize;   /* Requested offscreen size as width << 32 | height, 0 renders to the window surface */
+    GLCaptureRequest*  request;      /* Capture of the next drawn frame, taken by it, NULL when none */
+    unsigned int       framebuffer;  /* Offscreen target, created by the next frame */
+    unsigned int       colorTexture;
+    unsigned int       depthBuffer;
+    int                width;        /* Size of the offscreen target */
+    int                height;
+    char*              requestPath;  /* Request taken by the frame being drawn, NULL when none */
+    int                requestFormat;
+    GLCaptureSlot      slots[GL_CAPTURE_SLOTS];
+    int                nextSlot;     /* Slots are used in turn, so they finish in order */
+    int                failed;       /* Frames lost before reaching the writer */
+    ImageWriteStatus   writes;       /* Frames handed to the writer */
+} GLCapture;
+
+/* A GL object owned by an instance */
+typedef struct {
+    unsigned int kind;
+    unsigned int name;
+    size_t       bytes;
+} GLResource;
+
+/* Every GL object an instance created and has not deleted yet */
+typedef struct {
+    GLResource*     objects;
+    int             count;
+    int             capacity;
+    GLResourceStats stats;
+} GLResourceRegistry;
+
+/* Programs kept in the snapshot */
+typedef enum {
+    GL_SNAPSHOT_PROGRAM = 0,     /* GLES3 program binaries */
+    GL_SNAPSHOT_INSTANCE_PROGRAM,
+    GL_SNAPSHOT_ENTRY_COUNT
+} GLSnapshotId;
+
+typedef struct {
+    size_t       offset;         /* Into the snapshot data */
+    size_t       size;           /* 0 when the part is not kept */
+    unsigned int format;         /* Program binary format */
+} GLSnapshotEntry;
+
+/* CPU-side copy of the programs intializeGL() linked, so a lost context is rebuilt without
+ * compiling anything. The mesh is not copied, it is mapped from its file again. */
+typedef struct {
+    unsigned char*     data;     /* The parts back to back */
+    size_t             size;
+    unsigned long long key;      /* Driver and GLES version the parts were built for */
+    GLSnapshotEntry    entries[GL_SNAPSHOT_ENTRY_COUNT];
+} GLSnapshot;
+
+/* Camera looking at a target from an orbit around it. Zero initialized it is the orthographic
+ * view of [-1, 1] the renderer always had. */
+typedef struct {
+    int          projectionType; /* GLCameraProjection */
+    int          controller;     /* GLCameraController */
+    float        fovY;           /* Perspective field of view across the short side in degrees, 0 for 45 */
+    float        yaw;            /* Orbit around the target in degrees */
+    float        pitch;
+    float        zoom;           /* Doublings of the magnification */
+    float        target[3];
+
+    /* Cached matrices, recomputed by the next frame after whatever they depend on changed */
+    float        view[16];
+    float        projection[16]; /* Pre-rotated onto the surface by the window angle */
+    float        viewProjection[16];
+    bool         viewValid;
+    bool         projectionValid;
+    int          width;          /* Surface the projection was computed for */
+    int          height;
+    int          angle;
+    unsigned int version;        /* Incremented whenever viewProjection changes */
+} GLCamera;
+
+/* Application data */
+struct GLDATA {
+    float model[16];             /* Rotation of displayOrientation, recomputed when it changes */
+    unsigned int modelVersion;   /* Incremented whenever model changes */
+    float mvp[16];
+
+    /* Cube rotation as a unit quaternion (x, y, z, w), turned incrementally by every drag */
+    float orientation[4];
+    bool arcball;                /* Touch drags turn the cube like a trackball, see setArcballRotation() */
+    FloatPoint curPoint;
+    FloatPoint prevPoint;
+
+    GLuint       vtx_shader;
+    GLuint       fgmt_shader;
+    /*A program object is an object to which shader objects can be attached*/
+    unsigned int program;
+    int          mvpLocation;    /* Resolved once after linking */
+    int          mvpUploaded;    /* mvp holds the value of the mvpMatrix uniform */
+    unsigned int mvpModelVersion; /* Model and camera versions mvp was computed for */
+    unsigned int mvpCameraVersion;
+
+    /* Generate Vertex Buffer */
+    unsigned int vbo;
+
+    /* Indexed cube geometry in a packed vertex format */
+    unsigned int ibo;
+    int          indexCount;
+    unsigned int indexType;
+    int          vertexFormat;   /* Packed format of vbo, half float positions when supported */
+    char*        meshPath;       /* Binary mesh file drawn instead of the cube, or NULL */
+
+    int width;
+    int height;
+
+    bool mouse_down;
+
+    int windowAngle;
+
+    GLCamera camera;
+
+    /* Render on demand: renderFrameGL() only draws when dirty. dirty is set by any thread after the
+     * state it announces and taken atomically by the render thread before reading that state. */
+    bool renderOnDemand;
+    bool dirty;
+
+    /* GLES major version of the current context, detected at initialization */
+    int glesVersion;
+
+    /* Field of cubes, drawn instead of the single cube when instanceCount > 1 */
+    int instanceCount;
+    float* instanceOffsets;      /* x, y, z, scale per instance */
+    float* instanceMvps;         /* GLES2: 16 floats per instance, uploaded as uniform batches */
+    GLuint       instanceVtxShader;
+    GLuint       instanceFgmtShader;
+    unsigned int instanceProgram;
+    GLStreamBuffer instanceStream;   /* GLES3: per-instance matrices */
+    unsigned int instanceVbo;    /* GLES2: replicated batch geometry */
+    unsigned int instanceIbo;    /* GLES2: indices of the replicated batch geometry */
+    unsigned int instanceIndexType;
+    int          instanceBatchSize;  /* GLES2: mesh copies in the batch geometry */
+    int          instanceMvpLocation;
+    int          instancingFailed;   /* The field program failed to build, the error is logged */
+
+    /* Frustum culling of the field against the view volume, through a BVH over the instance bounds */
+    bool             cullingDisabled;
+    float            meshRadius;         /* Bounding sphere of the mesh around its origin */
+    struct CullTree* cullTree;           /* Built on the first culled frame, NULL when it must be rebuilt */
+    int*             visibleInstances;   /* Indices found by the last query */
+    float*           visibleOffsets;     /* instanceOffsets of the visible instances, in draw order */
+    struct JobPool*  jobs;               /* Culling and matrix threads, started by the first parallel frame */
+
+    GLStateCache state;
+
+    /* Touch and rotation input from the UI thread, drained once per frame by renderFrameGL() */
+    GLInputQueue input;
+
+    /* Drag prediction: the model is drawn at displayOrientation, orientation plus the rotation the
+     * drag is expected to add by the time the frame is presented. orientation only follows real samples. */
+    float      predictionLead;   /* Milliseconds from rendering to presentation, 0 disables prediction */
+    FloatPoint velocity;         /* Smoothed drag velocity in pixels per millisecond */
+    double     lastMotionTime;
+    float      displayOrientation[4];
+
+    GLFrameTiming timing;
+
+    GLCapture capture;
+
+    /* GL objects created by intializeGL() and later frames, released by terminateGL() */
+    GLResourceRegistry resources;
+    bool               initialized;  /* intializeGL() ran and terminateGL() did not yet */
+
+    /* Kept from intializeGL() to terminateGL(), restores the scene after notifyGLContextLost() */
+    GLSnapshot snapshot;
+    bool       contextLost;      /* The next intializeGL() restores the scene and keeps the view */
+    void*      context;          /* EGLContext current at intializeGL(), the only one its objects are deleted on */
+};
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_LIBRARY_PRIVATE_H__ */
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_MATRIX_PRIVATE_H__
+#define __DALI_NATIVEGL_MATRIX_PRIVATE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 4x4 matrices are column-major float[16] as uploaded with glUniformMatrix4fv.
+ * Uses SSE on x86 and NEON on ARM, with a scalar fallback otherwise.
+ * Output arguments may alias the inputs unless stated otherwise.
+ */
+
+/*
+ * @ brief Name of the instruction set in use: "sse", "neon" or "scalar".
+ */
+const char* matrix_simd_name(void);
+
+/*
+ * @ brief Set matrix to identity.
+ */
+void matrix_identity(float matrix[16]);
+
+/*
+ * @ brief matrix = matrix0 x matrix1
+ */
+void matrix_multiply(float matrix[16], const float matrix0[16], const float matrix1[16]);
+
+/*
+ * @ brief result[i] = matrix0 x matrices[i] for count matrices.
+ * @ param[in] result   count * 16 floats, must not alias matrix0.
+ * @ param[in] matrices count * 16 floats, may alias result.
+ */
+void matrix_multiply_batch(float* result, const float matrix0[16], const float* matrices, int count);
+
+/*
+ * @ brief Rotation matrix for Euler angles in degrees, same convention as rotate_xyz().
+ */
+void matrix_rotation_xyz(float result[16], const float anglex, const float angley, const float anglez);
+
+/*
+ * @ brief matrix = matrix x rotation(anglex, angley, anglez)
+ * @ details Only the three rotated columns are computed, the translation column is kept.
+ */
+void matrix_rotate_xyz(float matrix[16], const float anglex, const float angley, const float anglez);
+
+/*
+ * @ brief Transform count points (x, y, z, 1) by matrix into vec4 results.
+ * @ param[in] result       Destination of the first vec4, advanced by resultStride floats.
+ * @ param[in] points       Source of the first xyz, advanced by pointStride floats.
+ * @ details result must not overlap points or matrix.
+ */
+void matrix_transform_points(float* result, int resultStride, const float matrix[16],
+                             const float* points, int pointStride, int count);
+
+/*
+ * @ brief Orthographic projection, see glOrtho().
+ * @ return 0 when the volume is empty.
+ */
+int matrix_ortho(float result[16], const float left, const float right,
+                 const float bottom, const float top, const float near, const float far);
+
+/*
+ * @ brief Perspective projection, see glFrustum().
+ * @ return 0 when the volume is empty or near is not in front of the eye.
+ */
+int matrix_frustum(float result[16], const float left, const float right,
+                   const float bottom, const float top, const float near, const float far);
+
+/*
+ * Quaternions are float[4] (x, y, z, w), rotations are unit quaternions.
+ */
+
+/*
+ * @ brief Rotation by degrees around the unit axis (x, y, z).
+ */
+void quaternion_rotation(float result[4], const float x, const float y, const float z, const float degrees);
+
+/*
+ * @ brief Shortest rotation taking the unit vector from onto the unit vector to, without trigonometry.
+ * @ details Opposite vectors give a half turn around an axis perpendicular to from.
+ */
+void quaternion_between(float result[4], const float from[3], const float to[3]);
+
+/*
+ * @ brief result = quaternion0 x quaternion1, quaternion1 is applied first.
+ */
+void quaternion_multiply(float result[4], const float quaternion0[4], const float quaternion1[4]);
+
+/*
+ * @ brief Scale back to unit length, against the drift of repeated multiplications.
+ */
+void quaternion_normalize(float quaternion[4]);
+
+/*
+ * @ brief Rotation matrix of the unit quaternion.
+ */
+void matrix_from_quaternion(float result[16], const float quaternion[4]);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_MATRIX_PRIVATE_H__ */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_MESH_PRIVATE_H__
+#define __DALI_NATIVEGL_MESH_PRIVATE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Packed vertex formats. Every vertex is a position followed by a normalized RGBA8 color,
+ * padded to a multiple of 4 bytes.
+ */
+typedef enum {
+    MESH_FORMAT_FLOAT = 0,      /* float x, y, z; ubyte r, g, b, a   : 16 bytes */
+    MESH_FORMAT_HALF_FLOAT = 1  /* half x, y, z, pad; ubyte r, g, b, a : 12 bytes */
+} MeshFormat;
+
+/* Indexed triangle list in a packed vertex format */
+typedef struct {
+    MeshFormat format;
+
+    const unsigned char* vertices;
+    int vertexCount;
+
+    const void* indices;
+    int indexCount;
+    int indexSize;              /* 1, 2 or 4 bytes per index */
+
+    void* storage;              /* Owned allocation behind vertices, or NULL */
+    void* indexStorage;         /* Owned allocation behind indices, or NULL */
+    void* mapping;              /* Mapped mesh file behind vertices/indices, or NULL */
+    size_t mappingSize;
+} Mesh;
+
+/*
+ * Binary mesh file, written by dali-nativegl-mesh-converter. The vertex and index data are
+ * stored exactly as uploaded to GL so a loaded file is mapped and used in place. All fields
+ * are little endian, the data offsets are multiples of MESH_FILE_ALIGNMENT.
+ */
+#define MESH_FILE_MAGIC "DNGM"
+#define MESH_FILE_VERSION 1
+#define MESH_FILE_ALIGNMENT 16
+
+typedef struct {
+    char     magic[4];
+    uint32_t version;
+    uint32_t format;            /* MeshFormat */
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;
+    uint32_t vertexOffset;      /* From the start of the file */
+    uint32_t indexOffset;
+} MeshFileHeader;
+
+/*
+ * @ brief Bytes per vertex of a format.
+ */
+int mesh_format_stride(MeshFormat format);
+
+/*
+ * @ brief Byte offset of the color inside a vertex of a format.
+ */
+int mesh_format_color_offset(MeshFormat format);
+
+/*
+ * @ brief Build an indexed mesh from an expanded triangle list.
+ * @ param[in] mesh        The mesh to fill in, release with mesh_destroy().
+ * @ param[in] vertices    vertexCount vertices of x, y, z, r, g, b floats, colors in [0, 1].
+ * @ param[in] vertexCount Number of vertices, a multiple of 3.
+ * @ param[in] format      Packed format of the result.
+ * @ details Vertices that are identical once packed are shared, the index size is the
+ *          smallest one that addresses all unique vertices.
+ * @ return 1 on success, 0 when out of memory.
+ */
+int mesh_create_indexed(Mesh* mesh, const float* vertices, int vertexCount, MeshFormat format);
+
+/*
+ * @ brief Map a binary mesh file, vertices and indices point into the mapping.
+ * @ param[in] mesh The mesh to fill in, release with mesh_destroy().
+ * @ details Nothing is parsed or copied; the header is checked and the indices are verified
+ *          to address existing vertices so a bad file cannot make GL read out of bounds.
+ * @ return 1 on success, 0 when the file cannot be mapped or is not a valid mesh file.
+ */
+int mesh_load_file(Mesh* mesh, const char* path);
+
+/*
+ * @ brief Write a mesh in the binary mesh file format.
+ * @ return 1 on success, 0 on I/O error.
+ */
+int mesh_write_file(const Mesh* mesh, const char* path);
+
+/*
+ * @ brief Release the storage or mapping owned by the mesh.
+ */
+void mesh_destroy(Mesh* mesh);
+
+/*
+ * @ brief Size in bytes of the vertex and index data.
+ */
+size_t mesh_vertex_bytes(const Mesh* mesh);
+size_t mesh_index_bytes(const Mesh* mesh);
+
+/*
+ * @ brief GL index type for an index size (GL_UNSIGNED_BYTE/SHORT/INT).
+ */
+unsigned int mesh_index_type(int indexSize);
+
+/*
+ * @ brief Convert a float to IEEE 754 half precision, rounding to nearest even.
+ */
+unsigned short mesh_float_to_half(float value);
+
+/*
+ * @ brief Convert an IEEE 754 half precision value to a float, exactly.
+ */
+float mesh_half_to_float(unsigned short value);
+
+/*
+ * @ brief Axis aligned bounds of the vertex positions: min x, y, z then max x, y, z.
+ */
+void mesh_bounds(const Mesh* mesh, float box[6]);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_MESH_PRIVATE_H__ */
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_PROGRAM_PRIVATE_H__
+#define __DALI_NATIVEGL_PROGRAM_PRIVATE_H__
+
+#include <GLES3/gl3.h>
+#include <dali-nativegl-library_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Attribute location bound before linking */
+typedef struct {
+    GLuint      index;
+    const char* name;
+} ProgramAttrib;
+
+/*
+ * @ brief Create a linked program, from the program binary cache when possible.
+ * @ param[in]  resources   Registry of the program and its shaders.
+ * @ param[in]  attribs     Attribute locations to bind, part of the cache key.
+ * @ param[in]  glesVersion Program binaries are used on GLES3 only.
+ * @ param[out] vtxShader   The compiled shaders, 0 when the program came from the cache.
+ * @ details Compile and link errors are logged with the driver's info log. A program that was
+ *          compiled is stored in the cache for the next run.
+ * @ return The program, or 0 when it failed to compile or link.
+ */
+GLuint program_create(GLResourceRegistry* resources, const char* vtxSource, const char* fgmtSource,
+                      const ProgramAttrib* attribs, int attribCount, int glesVersion, GLuint* vtxShader, GLuint* fgmtShader);
+
+/*
+ * @ brief Create a program from a binary of program_get_binary().
+ * @ return The program, or 0 when the driver rejected the binary.
+ */
+GLuint program_load_binary(GLResourceRegistry* resources, GLenum binaryFormat, const void* binary, size_t length);
+
+/*
+ * @ brief Binary of a linked program, GLES3 only.
+ * @ return The binary to free(), or NULL when the driver has none.
+ */
+void* program_get_binary(GLuint program, GLenum* binaryFormat, size_t* length);
+
+/*
+ * @ brief Directory of the program binary cache, NULL disables it.
+ * @ return 1 on success, 0 when out of memory.
+ */
+int program_set_cache_directory(const char* directory);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_PROGRAM_PRIVATE_H__ */
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_RESOURCE_PRIVATE_H__
+#define __DALI_NATIVEGL_RESOURCE_PRIVATE_H__
+
+#include <GLES3/gl3.h>
+#include <dali-nativegl-library_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Registry of the GL objects an instance owns. Objects are created and deleted through it, so
+ * it knows what is alive and how much storage was uploaded into it, and terminating can release
+ * whatever a code path forgot.
+ */
+
+/*
+ * @ brief Create a GL object and register it.
+ * @ param[in] type Shader type for GL_RESOURCE_SHADER, ignored otherwise.
+ * @ return The object name, or 0 when GL or the registry is out of memory.
+ */
+GLuint resource_create(GLResourceRegistry* registry, GLResourceKind kind, GLenum type);
+
+/*
+ * @ brief Register an object created elsewhere, e.g. a program from the binary cache.
+ * @ return 1 on success, 0 when out of memory (the object is deleted then).
+ */
+int resource_track(GLResourceRegistry* registry, GLResourceKind kind, GLuint name);
+
+/*
+ * @ brief Record the storage size of an object after uploading into it.
+ */
+void resource_set_bytes(GLResourceRegistry* registry, GLResourceKind kind, GLuint name, size_t bytes);
+
+/*
+ * @ brief Delete a registered object and set *name to 0.
+ * @ details Only *name is cleared when it is 0 or no longer registered, e.g. after resource_forget_all().
+ */
+void resource_delete(GLResourceRegistry* registry, GLResourceKind kind, GLuint* name);
+
+/*
+ * @ brief Delete every object still registered, on the context they were created with.
+ * @ return The number of objects deleted, also counted as reclaimed in the statistics.
+ */
+int resource_release_all(GLResourceRegistry* registry);
+
+/*
+ * @ brief Forget every object without calling GL, they went away with a lost context.
+ */
+void resource_forget_all(GLResourceRegistry* registry);
+
+/*
+ * @ brief Free the registry's memory, after its objects were released.
+ */
+void resource_terminate(GLResourceRegistry* registry);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_RESOURCE_PRIVATE_H__ */
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __DALI_NATIVEGL_SNAPSHOT_PRIVATE_H__
+#define __DALI_NATIVEGL_SNAPSHOT_PRIVATE_H__
+
+#include <GLES3/gl3.h>
+#include <dali-nativegl-library_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * CPU-side copy of the program binaries an initialization links, in one block. A lost context
+ * loads them as they are instead of compiling; the mesh is mapped or generated again.
+ */
+
+/*
+ * @ brief Start an initialization with the current context, dropping the parts when they were
+ *         built for another driver or GLES version.
+ */
+void snapshot_begin(GLSnapshot* snapshot, int glesVersion);
+
+/*
+ * @ brief Keep a copy of data as part id, replacing the previous one.
+ * @ return 1 on success, 0 when out of memory (the part is not kept then).
+ */
+int snapshot_store(GLSnapshot* snapshot, GLSnapshotId id, const void* data, size_t size, unsigned int format);
+
+/*
+ * @ brief Look up part id.
+ * @ param[out] entry Size and format of the part.
+ * @ return The part's data, valid until the next store, or NULL when it is not kept.
+ */
+const void* snapshot_find(const GLSnapshot* snapshot, GLSnapshotId id, GLSnapshotEntry* entry);
+
+/*
+ * @ brief Drop every part and free the memory.
+ */
+void snapshot_clear(GLSnapshot* snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_SNAPSHOT_PRIVATE_H__ */
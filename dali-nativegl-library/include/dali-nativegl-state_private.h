@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_STATE_PRIVATE_H__
+#define __DALI_NATIVEGL_STATE_PRIVATE_H__
+
+#include <GLES3/gl3.h>
+#include <dali-nativegl-library_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Every GL state change of the renderer goes through these functions. A change equal to the
+ * cached value is counted as skipped and not passed to GL. Binding is not tracked for objects
+ * deleted behind the cache's back, so call state_invalidate() after deleting objects.
+ */
+
+/* GLStateCache::validMask */
+#define STATE_PROGRAM               (1u << 0)
+#define STATE_ARRAY_BUFFER          (1u << 1)
+#define STATE_ELEMENT_ARRAY_BUFFER  (1u << 2)
+#define STATE_VIEWPORT              (1u << 3)
+#define STATE_CLEAR_COLOR           (1u << 4)
+#define STATE_DEPTH_TEST            (1u << 5)
+
+/* GLAttribState::validMask */
+#define STATE_ATTRIB_POINTER        (1u << 0)
+#define STATE_ATTRIB_ENABLED        (1u << 1)
+#define STATE_ATTRIB_DIVISOR        (1u << 2)
+
+/*
+ * @ brief Mark the whole cached state unknown, the next change of each item reaches GL.
+ */
+void state_invalidate(GLStateCache* state);
+
+void state_use_program(GLStateCache* state, GLuint program);
+void state_bind_buffer(GLStateCache* state, GLenum target, GLuint buffer);
+void state_viewport(GLStateCache* state, GLint x, GLint y, GLsizei width, GLsizei height);
+void state_clear_color(GLStateCache* state, GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+void state_depth_test(GLStateCache* state, int enable);
+
+/*
+ * @ brief glVertexAttribPointer() sourcing from buffer, binds it to GL_ARRAY_BUFFER when needed.
+ */
+void state_vertex_attrib_pointer(GLStateCache* state, GLuint index, GLuint buffer, GLint size, GLenum type,
+                                 GLboolean normalized, GLsizei stride, const void* offset);
+void state_enable_attrib(GLStateCache* state, GLuint index, int enable);
+
+/*
+ * @ brief glVertexAttribDivisor(), GLES3 only.
+ */
+void state_attrib_divisor(GLStateCache* state, GLuint index, GLuint divisor);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_STATE_PRIVATE_H__ */
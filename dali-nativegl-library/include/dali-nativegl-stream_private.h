@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_STREAM_PRIVATE_H__
+#define __DALI_NATIVEGL_STREAM_PRIVATE_H__
+
+#include <dali-nativegl-library_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Streaming buffers hold data the CPU rewrites every frame. With mapping (GLES3) the buffer is
+ * a ring of GL_STREAM_REGIONS regions: a frame maps its region unsynchronized and fences the
+ * draws reading it, so the CPU only waits when the GPU is that many frames behind. Without
+ * (GLES2) every frame orphans the storage, the driver renames it instead of waiting.
+ *
+ *   data = stream_map(stream, state, resources, size, &offset);   write size bytes to data
+ *   stream_unmap(stream);                                          draw from offset in stream->buffer
+ *   stream_fence(stream);                                          after the last draw reading them
+ */
+
+/*
+ * @ brief Create the buffer on the current context.
+ * @ param[in] mapped Use mapped regions, needs GLES3.
+ */
+void stream_init(GLStreamBuffer* stream, GLResourceRegistry* resources, int mapped);
+
+/*
+ * @ brief Start writing size bytes, binding the buffer to GL_ARRAY_BUFFER.
+ * @ param[out] offset Offset of the data in the buffer once unmapped.
+ * @ return Where to write, NULL when out of memory.
+ */
+void* stream_map(GLStreamBuffer* stream, GLStateCache* state, GLResourceRegistry* resources, int size, int* offset);
+
+/*
+ * @ brief Finish writing, the buffer must still be bound to GL_ARRAY_BUFFER.
+ * @ return 1 when the data is in the buffer, 0 when it was lost and must not be drawn.
+ */
+int stream_unmap(GLStreamBuffer* stream);
+
+/*
+ * @ brief Mark the end of the commands reading the data of this frame.
+ */
+void stream_fence(GLStreamBuffer* stream);
+
+/*
+ * @ brief Delete the buffer and fences, on the context of stream_init().
+ * @ param[in] contextLost The context is gone, only forget the fences.
+ */
+void stream_terminate(GLStreamBuffer* stream, GLResourceRegistry* resources, int contextLost);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_STREAM_PRIVATE_H__ */
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_TIMING_PRIVATE_H__
+#define __DALI_NATIVEGL_TIMING_PRIVATE_H__
+
+#include <GLES2/gl2.h>
+#include <dali-nativegl-library_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * @ brief Start of a CPU pass.
+ * @ return The current time in milliseconds, 0 when timing is disabled.
+ */
+double timing_cpu_begin(const GLFrameTiming* timing);
+
+/*
+ * @ brief Record a CPU pass started at timing_cpu_begin() time start.
+ */
+void timing_cpu_end(GLFrameTiming* timing, GLTimingPass pass, double start);
+
+/*
+ * @ brief Read back finished GPU queries and start timing the commands that follow.
+ * @ details Checks for GL_EXT_disjoint_timer_query on first use with a context. Nothing is
+ *          started when timing is disabled, unsupported, or all queries are still in flight.
+ * @ return 1 when a query was started and timing_gpu_end() must end it.
+ */
+int timing_gpu_begin(GLFrameTiming* timing);
+void timing_gpu_end(GLFrameTiming* timing, int started);
+
+/*
+ * @ brief Delete the queries of the current context, samples are kept.
+ * @ param[in] contextLost The queries went away with their context, only forget them.
+ */
+void timing_terminate(GLFrameTiming* timing, int contextLost);
+
+/*
+ * @ return 1 when stats was filled, 0 when the pass has no samples.
+ */
+int timing_stats(const GLFrameTiming* timing, GLTimingPass pass, GLTimingStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_TIMING_PRIVATE_H__ */
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_TRACE_PRIVATE_H__
+#define __DALI_NATIVEGL_TRACE_PRIVATE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Tracing is compiled in with NATIVEGL_TRACE (cmake -DENABLE_TRACING=ON). Without it the
+ * macros expand to nothing and only trace_dump() / trace_reset() remain, as no-ops.
+ *
+ * Names must be string literals, events keep the pointer. Events go to a fixed ring that
+ * overwrites the oldest ones and is written as Chrome trace JSON (chrome://tracing, Perfetto).
+ *
+ *   TRACE_SCOPE("render");              span until the end of the enclosing block
+ *   TRACE_COUNTER("draw_calls", n);     counter track
+ *   TRACE_INSTANT("resize");            point in time
+ */
+#ifdef NATIVEGL_TRACE
+
+typedef struct {
+    const char* name;
+    double      start;   /* Microseconds */
+} TraceSpan;
+
+TraceSpan trace_span_begin(const char* name);
+void trace_span_end(TraceSpan* span);
+void trace_counter(const char* name, double value);
+void trace_instant(const char* name);
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) \
+  TraceSpan TRACE_CONCAT(traceSpan, __LINE__) __attribute__((cleanup(trace_span_end))) = trace_span_begin("" name)
+#define TRACE_COUNTER(name, value) trace_counter("" name, (double)(value))
+#define TRACE_INSTANT(name) trace_instant("" name)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+
+#endif
+
+/*
+ * @ brief Write the events in the ring as Chrome trace JSON.
+ * @ details Events written while dumping may be missing from the file, they are never torn.
+ * @ return 1 on success, 0 when the file cannot be written or tracing is compiled out.
+ */
+int trace_dump(const char* path);
+
+/*
+ * @ brief Discard the recorded events.
+ */
+void trace_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_TRACE_PRIVATE_H__ */
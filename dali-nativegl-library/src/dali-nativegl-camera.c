@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <math.h>
+
+#include <dali-nativegl-camera_private.h>
+#include <dali-nativegl-matrix_private.h>
+
+#define CAMERA_DEFAULT_FOV 45.0f
+
+/* Depth range of the orthographic projection around the target, as the renderer always had */
+#define CAMERA_ORTHO_NEAR -1.0f
+#define CAMERA_ORTHO_FAR 100.0f
+
+/* Perspective near plane as a fraction of the distance to the target, and depth behind it */
+#define CAMERA_NEAR_RATIO 0.05f
+#define CAMERA_DEPTH 100.0f
+
+/* Drags: one degree per pixel like the cube rotation, one doubling per 100 pixels of zoom */
+#define CAMERA_DEGREES_PER_PIXEL 1.0f
+#define CAMERA_ZOOM_PER_PIXEL 0.01f
+#define CAMERA_MAX_PITCH 89.0f
+#define CAMERA_MAX_ZOOM 8.0f
+
+#define DEGREE_TO_RADIAN 0.0174532925199432957692369076849f
+
+static float clamp(float value, float limit);
+static float field_of_view(const GLCamera* camera);
+static float target_distance(const GLCamera* camera);
+static void update_projection(GLCamera* camera);
+static void update_view(GLCamera* camera);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static float clamp(float value, float limit)
+{
+  return value > limit ? limit : (value < -limit ? -limit : value);
+}
+
+static float field_of_view(const GLCamera* camera)
+{
+  return camera->fovY > 0.0f && camera->fovY < 180.0f ? camera->fovY : CAMERA_DEFAULT_FOV;
+}
+
+/*
+ * @ brief Distance of the perspective eye from the target: at zoom 0 the field of view spans
+ *         [-1, 1] at the target, like the orthographic projection.
+ */
+static float target_distance(const GLCamera* camera)
+{
+  return exp2f(-camera->zoom) / tanf(field_of_view(camera) * 0.5f * DEGREE_TO_RADIAN);
+}
+
+/*
+ * @ brief Projection for the window size, pre-rotated onto the surface by the window angle.
+ * @ details The surface keeps its natural orientation and the window content is rotated into it
+ *          in clip space, after the aspect correction, so a rotated window is not stretched.
+ */
+static void update_projection(GLCamera* camera)
+{
+  float volume[16];
+  float preRotation[16];
+  float aspect, halfX, halfY;
+
+  camera->projectionValid = true;
+  matrix_identity(camera->projection);
+  if (camera->width <= 0 || camera->height <= 0)
+  {
+    return;
+  }
+
+  /* [-1, 1] across the short side */
+  aspect = camera->width > camera->height ? (float)camera->width / camera->height : (float)camera->height / camera->width;
+  halfX = camera->width > camera->height ? aspect : 1.0f;
+  halfY = camera->width > camera->height ? 1.0f : aspect;
+  if (camera->projectionType == GL_CAMERA_PERSPECTIVE)
+  {
+    const float distance = target_distance(camera);
+    const float near = distance * CAMERA_NEAR_RATIO;
+    const float extent = near * tanf(field_of_view(camera) * 0.5f * DEGREE_TO_RADIAN);
+    matrix_frustum(volume, -halfX * extent, halfX * extent, -halfY * extent, halfY * extent, near, distance + CAMERA_DEPTH);
+  }
+  else
+  {
+    const float extent = exp2f(-camera->zoom);
+    matrix_ortho(volume, -halfX * extent, halfX * extent, -halfY * extent, halfY * extent, CAMERA_ORTHO_NEAR, CAMERA_ORTHO_FAR);
+  }
+
+  /* Quarter turns are exact, sincosf(90) is not */
+  matrix_identity(preRotation);
+  switch (camera->angle)
+  {
+    case 0:
+      break;
+    case 90:
+      preRotation[0] = 0.0f;  preRotation[1] = 1.0f;
+      preRotation[4] = -1.0f; preRotation[5] = 0.0f;
+      break;
+    case 180:
+      preRotation[0] = -1.0f; preRotation[5] = -1.0f;
+      break;
+    case 270:
+      preRotation[0] = 0.0f;  preRotation[1] = -1.0f;
+      preRotation[4] = 1.0f;  preRotation[5] = 0.0f;
+      break;
+    default:
+      matrix_rotation_xyz(preRotation, 0.0f, 0.0f, (float)camera->angle);
+      break;
+  }
+  matrix_multiply(camera->projection, preRotation, volume);
+}
+
+/*
+ * @ brief view = translate(0, 0, -distance) x rotateX(pitch) x rotateY(-yaw) x translate(-target)
+ * @ details The orthographic eye sits on the target, its depth range reaches both ways.
+ */
+static void update_view(GLCamera* camera)
+{
+  int i;
+
+  camera->viewValid = true;
+  matrix_rotation_xyz(camera->view, camera->pitch, 0.0f, 0.0f);
+  matrix_rotate_xyz(camera->view, 0.0f, -camera->yaw, 0.0f);
+  for (i = 0; i < 3; i++)
+  {
+    camera->view[12 + i] = -(camera->view[i] * camera->target[0] + camera->view[4 + i] * camera->target[1] +
+                             camera->view[8 + i] * camera->target[2]);
+  }
+  if (camera->projectionType == GL_CAMERA_PERSPECTIVE)
+  {
+    camera->view[14] -= target_distance(camera);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const float* camera_update(GLCamera* camera, int width, int height, int angle)
+{
+  int changed = 0;
+
+  if (!camera->projectionValid || width != camera->width || height != camera->height || angle != camera->angle)
+  {
+    camera->width = width;
+    camera->height = height;
+    camera->angle = angle;
+    update_projection(camera);
+    changed = 1;
+  }
+  if (!camera->viewValid)
+  {
+    update_view(camera);
+    changed = 1;
+  }
+  if (changed)
+  {
+    matrix_multiply(camera->viewProjection, camera->projection, camera->view);
+    camera->version++;
+  }
+  return camera->viewProjection;
+}
+
+int camera_drag(GLCamera* camera, float dx, float dy, int shortSide)
+{
+  switch (camera->controller)
+  {
+    case GL_CAMERA_CONTROL_ORBIT:
+      /* The scene turns with the finger, like the cube does */
+      camera->yaw -= dx * CAMERA_DEGREES_PER_PIXEL;
+      camera->pitch = clamp(camera->pitch + dy * CAMERA_DEGREES_PER_PIXEL, CAMERA_MAX_PITCH);
+      break;
+    case GL_CAMERA_CONTROL_PAN:
+    {
+      /* The short side of the window spans 2 * 2^-zoom units at the target, the scene follows the finger */
+      const float units = 2.0f * exp2f(-camera->zoom) / (shortSide > 0 ? shortSide : 1);
+      float rotation[16];
+      int i;
+
+      /* Rows 0 and 1 of the view rotation are the camera's right and up axes */
+      matrix_rotation_xyz(rotation, camera->pitch, 0.0f, 0.0f);
+      matrix_rotate_xyz(rotation, 0.0f, -camera->yaw, 0.0f);
+      for (i = 0; i < 3; i++)
+      {
+        camera->target[i] += (rotation[i * 4 + 1] * dy - rotation[i * 4] * dx) * units;
+      }
+      break;
+    }
+    case GL_CAMERA_CONTROL_ZOOM:
+      camera->zoom = clamp(camera->zoom - dy * CAMERA_ZOOM_PER_PIXEL, CAMERA_MAX_ZOOM);
+      camera->projectionValid = false;
+      break;
+    default:
+      return 0;
+  }
+  camera->viewValid = false;
+  return 1;
+}
+
+void camera_reset(GLCamera* camera)
+{
+  camera->yaw = 0.0f;
+  camera->pitch = 0.0f;
+  camera->zoom = 0.0f;
+  camera->target[0] = 0.0f;
+  camera->target[1] = 0.0f;
+  camera->target[2] = 0.0f;
+  camera->viewValid = false;
+  camera->projectionValid = false;
+}
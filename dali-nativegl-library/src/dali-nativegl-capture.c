@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <GLES3/gl3.h>
+
+#include <dlog.h>
+#include <dali-nativegl-capture_private.h>
+#include <dali-nativegl-image_private.h>
+#include <dali-nativegl-resource_private.h>
+
+#define NATIVEGL_LOG_TAG "DALI_NATIVEGL_LIBRARY"
+
+/* Nanoseconds per wait for a readback fence, repeated until it is signaled */
+#define CAPTURE_WAIT_TIMEOUT 100000000ull
+
+static void release_target(GLCapture* capture, GLResourceRegistry* resources);
+static int create_target(GLCapture* capture, GLResourceRegistry* resources, int width, int height);
+static int finish_slot(GLCapture* capture, GLCaptureSlot* slot, int wait);
+static void read_back(GLCapture* capture, GLResourceRegistry* resources, int width, int height);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static void release_target(GLCapture* capture, GLResourceRegistry* resources)
+{
+  resource_delete(resources, GL_RESOURCE_FRAMEBUFFER, &capture->framebuffer);
+  resource_delete(resources, GL_RESOURCE_TEXTURE, &capture->colorTexture);
+  resource_delete(resources, GL_RESOURCE_RENDERBUFFER, &capture->depthBuffer);
+  capture->width = 0;
+  capture->height = 0;
+}
+
+/*
+ * @ brief RGBA8 color texture and 16 bit depth, formats every GLES2 driver renders to.
+ * @ return 1 on success, 0 when the framebuffer is incomplete.
+ */
+static int create_target(GLCapture* capture, GLResourceRegistry* resources, int width, int height)
+{
+  const size_t pixels = (size_t)width * height;
+  GLenum status;
+
+  capture->colorTexture = resource_create(resources, GL_RESOURCE_TEXTURE, 0);
+  glBindTexture(GL_TEXTURE_2D, capture->colorTexture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  resource_set_bytes(resources, GL_RESOURCE_TEXTURE, capture->colorTexture, pixels * 4);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  capture->depthBuffer = resource_create(resources, GL_RESOURCE_RENDERBUFFER, 0);
+  glBindRenderbuffer(GL_RENDERBUFFER, capture->depthBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, height);
+  resource_set_bytes(resources, GL_RESOURCE_RENDERBUFFER, capture->depthBuffer, pixels * 2);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  capture->framebuffer = resource_create(resources, GL_RESOURCE_FRAMEBUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, capture->framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, capture->colorTexture, 0);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, capture->depthBuffer);
+  status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "offscreen target %dx%d incomplete (0x%x)\n",
+               width, height, status);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    release_target(capture, resources);
+    return 0;
+  }
+
+  capture->width = width;
+  capture->height = height;
+  return 1;
+}
+
+/*
+ * @ brief Pass the pixels of a finished readback to the writer thread.
+ * @ return 1 when the slot is free again, 0 while the copy is still in flight.
+ */
+static int finish_slot(GLCapture* capture, GLCaptureSlot* slot, int wait)
+{
+  GLsync fence = (GLsync)slot->fence;
+  const int size = slot->width * slot->height * 4;
+  unsigned char* pixels;
+  void* data;
+  GLenum status;
+
+  status = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? CAPTURE_WAIT_TIMEOUT : 0);
+  while (wait && status == GL_TIMEOUT_EXPIRED)
+  {
+    status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, CAPTURE_WAIT_TIMEOUT);
+  }
+  if (status == GL_TIMEOUT_EXPIRED)
+  {
+    return 0;
+  }
+  glDeleteSync(fence);
+  slot->fence = NULL;
+
+  pixels = (unsigned char*)malloc(size);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+  data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  if (data && pixels)
+  {
+    memcpy(pixels, data, size);
+  }
+  if (data)
+  {
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  if (data && pixels)
+  {
+    image_queue_write(&capture->writes, slot->path, slot->format, pixels, slot->width, slot->height);
+  }
+  else
+  {
+    dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "cannot read back %s\n", slot->path);
+    capture->failed++;
+    free(slot->path);
+    free(pixels);
+  }
+  slot->path = NULL;
+  return 1;
+}
+
+/*
+ * @ brief Start copying the bound framebuffer for the requested capture.
+ */
+static void read_back(GLCapture* capture, GLResourceRegistry* resources, int width, int height)
+{
+  GLCaptureSlot* slot = &capture->slots[capture->nextSlot];
+  const int size = width * height * 4;
+
+  /* All slots in flight: only then wait, for the oldest */
+  if (slot->fence)
+  {
+    finish_slot(capture, slot, 1);
+  }
+
+  if (!slot->pbo)
+  {
+    slot->pbo = resource_create(resources, GL_RESOURCE_BUFFER, 0);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+  if (slot->pboSize < size)
+  {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+    resource_set_bytes(resources, GL_RESOURCE_BUFFER, slot->pbo, size);
+    slot->pboSize = size;
+  }
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot->path = capture->requestPath;
+  slot->format = capture->requestFormat;
+  slot->width = width;
+  slot->height = height;
+  capture->requestPath = NULL;
+  capture->nextSlot = (capture->nextSlot + 1) % GL_CAPTURE_SLOTS;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int capture_set_target(GLCapture* capture, int width, int height)
+{
+  const unsigned long long size = width > 0 && height > 0 ?
+                                  (unsigned long long)width << 32 | (unsigned int)height : 0;
+
+  return __atomic_exchange_n(&capture->targetSize, size, __ATOMIC_ACQ_REL) != size;
+}
+
+int capture_request(GLCapture* capture, const char* path, int format)
+{
+  GLCaptureRequest* request = (GLCaptureRequest*)malloc(sizeof(GLCaptureRequest));
+  GLCaptureRequest* replaced;
+
+  if (!request || !(request->path = strdup(path)))
+  {
+    free(request);
+    return 0;
+  }
+  request->format = format;
+  replaced = __atomic_exchange_n(&capture->request, request, __ATOMIC_ACQ_REL);
+  if (replaced)
+  {
+    free(replaced->path);
+    free(replaced);
+  }
+  return 1;
+}
+
+int capture_begin_frame(GLCapture* capture, GLResourceRegistry* resources)
+{
+  unsigned long long size = __atomic_load_n(&capture->targetSize, __ATOMIC_ACQUIRE);
+  const int width = (int)(size >> 32);
+  const int height = (int)(size & 0xffffffffu);
+  GLCaptureRequest* request = __atomic_exchange_n(&capture->request, NULL, __ATOMIC_ACQUIRE);
+
+  if (request)
+  {
+    free(capture->requestPath);
+    capture->requestPath = request->path;
+    capture->requestFormat = request->format;
+    free(request);
+  }
+
+  if (capture->framebuffer && (capture->width != width || capture->height != height))
+  {
+    release_target(capture, resources);
+  }
+  if (!capture->framebuffer && size)
+  {
+    if (!create_target(capture, resources, width, height))
+    {
+      /* Logged, keep drawing to the window instead of retrying every frame, unless another
+       * size was requested meanwhile */
+      __atomic_compare_exchange_n(&capture->targetSize, &size, 0ull, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+      return 0;
+    }
+    return 1;
+  }
+  if (capture->framebuffer)
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, capture->framebuffer);
+    return 1;
+  }
+  return 0;
+}
+
+void capture_end_frame(GLCapture* capture, GLResourceRegistry* resources, int glesVersion, int width, int height)
+{
+  if (capture->requestPath && width > 0 && height > 0)
+  {
+    if (glesVersion >= 3)
+    {
+      read_back(capture, resources, width, height);
+    }
+    else
+    {
+      /* No pixel buffer objects, this read waits for the frame to be drawn */
+      unsigned char* pixels = (unsigned char*)malloc(width * height * 4);
+      if (pixels)
+      {
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        image_queue_write(&capture->writes, capture->requestPath, capture->requestFormat, pixels, width, height);
+      }
+      else
+      {
+        capture->failed++;
+        free(capture->requestPath);
+      }
+      capture->requestPath = NULL;
+    }
+  }
+
+  if (capture->framebuffer)
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+}
+
+void capture_poll(GLCapture* capture, int wait)
+{
+  int i;
+
+  /* From the oldest slot, a pending copy means the newer ones are pending too */
+  for (i = 0; i < GL_CAPTURE_SLOTS; i++)
+  {
+    GLCaptureSlot* slot = &capture->slots[(capture->nextSlot + i) % GL_CAPTURE_SLOTS];
+    if (slot->fence && !finish_slot(capture, slot, wait))
+    {
+      break;
+    }
+  }
+}
+
+void capture_terminate(GLCapture* capture, GLResourceRegistry* resources, int contextLost)
+{
+  int i;
+
+  release_target(capture, resources);
+  for (i = 0; i < GL_CAPTURE_SLOTS; i++)
+  {
+    GLCaptureSlot* slot = &capture->slots[i];
+    if (slot->fence)
+    {
+      if (!contextLost)
+      {
+        glDeleteSync((GLsync)slot->fence);
+      }
+      capture->failed++;
+    }
+    resource_delete(resources, GL_RESOURCE_BUFFER, &slot->pbo);
+    free(slot->path);
+    memset(slot, 0, sizeof(*slot));
+  }
+  capture->nextSlot = 0;
+}
+
+int capture_flush(GLCapture* capture)
+{
+  int failed;
+
+  capture_poll(capture, 1);
+  failed = capture->failed + image_wait_writes(&capture->writes);
+  capture->failed = 0;
+  return failed;
+}
+
+void capture_destroy(GLCapture* capture)
+{
+  GLCaptureRequest* request = __atomic_exchange_n(&capture->request, NULL, __ATOMIC_ACQUIRE);
+
+  if (request)
+  {
+    free(request->path);
+    free(request);
+  }
+  free(capture->requestPath);
+  capture->requestPath = NULL;
+  /* The writer thread updates writes until the last queued frame is written */
+  image_wait_writes(&capture->writes);
+}
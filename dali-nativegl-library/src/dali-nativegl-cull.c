@@ -0,0 +1,532 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <dali-nativegl-cull_private.h>
+
+/* Objects per leaf, and how much looser refitting may make the leaves before a rebuild */
+#define CULL_LEAF_SIZE 8
+#define CULL_REBUILD_GROWTH 2.0f
+
+/* Moved objects refit only their path to the root, up to 1/CULL_PATH_REFIT_RATIO of them */
+#define CULL_PATH_REFIT_RATIO 16
+
+/* The build splits at the median, so the depth stays below log2 of the object count */
+#define CULL_STACK_SIZE 64
+
+/* All six planes of the view volume still have to be tested */
+#define CULL_ALL_PLANES 0x3f
+
+typedef struct {
+    float box[6];
+    int   first;     /* The node covers tree->order[first .. first + count) */
+    int   count;
+    int   left;      /* Children left and left + 1, -1 for a leaf */
+} CullNode;
+
+struct CullTree {
+    CullNode* nodes;
+    int*      parents;   /* Parent of each node, -1 for the root */
+    int       nodeCount;
+    int*      order;     /* Object indices, grouped by node */
+    int*      leaves;    /* Leaf of each object */
+    float*    boxes;     /* 6 floats per object */
+    int       count;
+    int*      moved;     /* Objects updated since the last query */
+    int       movedCount;
+    int       refitAll;  /* Too many objects moved, refit the whole tree */
+    float     builtArea; /* Surface area of all leaves after the last build */
+    float     leafArea;  /* Surface area of all leaves now */
+};
+
+static float box_area(const float box[6]);
+static void box_union(float box[6], const float other[6]);
+static float centroid(const CullTree* tree, int object, int axis);
+static void select_median(CullTree* tree, int first, int count, int axis);
+static int build_node(CullTree* tree, int node, int first, int count, int next);
+static void build(CullTree* tree);
+static void fit_leaf(CullTree* tree, CullNode* node);
+static void refit_path(CullTree* tree, int object);
+static void refit(CullTree* tree);
+static void frustum_planes(float planes[6][4], const float clip[16]);
+static int append_objects(const CullTree* tree, const CullNode* node, int* visible, int visibleCount);
+static void prepare(CullTree* tree);
+static int query_subtree(const CullTree* tree, int root, const float clip[16], int* visible);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static float box_area(const float box[6])
+{
+  float dx = box[3] - box[0];
+  float dy = box[4] - box[1];
+  float dz = box[5] - box[2];
+  return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static void box_union(float box[6], const float other[6])
+{
+  int i;
+  for (i = 0; i < 3; i++)
+  {
+    box[i] = other[i] < box[i] ? other[i] : box[i];
+    box[i + 3] = other[i + 3] > box[i + 3] ? other[i + 3] : box[i + 3];
+  }
+}
+
+static float centroid(const CullTree* tree, int object, int axis)
+{
+  const float* box = tree->boxes + object * 6;
+  return box[axis] + box[axis + 3];
+}
+
+/*
+ * @ brief Partially order tree->order[first .. first + count) so the median object along axis
+ *         is in the middle, with smaller centroids before it and larger ones after (quickselect).
+ */
+static void select_median(CullTree* tree, int first, int count, int axis)
+{
+  int* order = tree->order;
+  int low = first;
+  int high = first + count - 1;
+  int median = first + count / 2;
+
+  while (low < high)
+  {
+    float pivot = centroid(tree, order[(low + high) / 2], axis);
+    int i = low;
+    int j = high;
+
+    while (i <= j)
+    {
+      while (centroid(tree, order[i], axis) < pivot)
+      {
+        i++;
+      }
+      while (centroid(tree, order[j], axis) > pivot)
+      {
+        j--;
+      }
+      if (i <= j)
+      {
+        int swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+        i++;
+        j--;
+      }
+    }
+    if (median <= j)
+    {
+      high = j;
+    }
+    else if (median >= i)
+    {
+      low = i;
+    }
+    else
+    {
+      break;
+    }
+  }
+}
+
+/*
+ * @ brief Fill in node for the objects order[first .. first + count) and build its children.
+ * @ param[in] next First free node, the children of a node are allocated as a pair.
+ * @ return The first free node after the subtree.
+ */
+static int build_node(CullTree* tree, int node, int first, int count, int next)
+{
+  CullNode* current = &tree->nodes[node];
+  int axis = 0;
+  int i;
+
+  memcpy(current->box, tree->boxes + tree->order[first] * 6, sizeof(current->box));
+  for (i = 1; i < count; i++)
+  {
+    box_union(current->box, tree->boxes + tree->order[first + i] * 6);
+  }
+  current->first = first;
+  current->count = count;
+  current->left = -1;
+
+  if (count <= CULL_LEAF_SIZE)
+  {
+    for (i = 0; i < count; i++)
+    {
+      tree->leaves[tree->order[first + i]] = node;
+    }
+    return next;
+  }
+
+  /* Split the longest side of the node at the median object */
+  for (i = 1; i < 3; i++)
+  {
+    if (current->box[i + 3] - current->box[i] > current->box[axis + 3] - current->box[axis])
+    {
+      axis = i;
+    }
+  }
+  select_median(tree, first, count, axis);
+
+  current->left = next;
+  tree->parents[next] = node;
+  tree->parents[next + 1] = node;
+  next = build_node(tree, current->left, first, count / 2, next + 2);
+  return build_node(tree, current->left + 1, first + count / 2, count - count / 2, next);
+}
+
+static void build(CullTree* tree)
+{
+  int i;
+
+  tree->nodeCount = 0;
+  tree->leafArea = 0.0f;
+  tree->movedCount = 0;
+  tree->refitAll = 0;
+  if (tree->count == 0)
+  {
+    return;
+  }
+
+  tree->parents[0] = -1;
+  tree->nodeCount = build_node(tree, 0, 0, tree->count, 1);
+  for (i = 0; i < tree->nodeCount; i++)
+  {
+    if (tree->nodes[i].left < 0)
+    {
+      tree->leafArea += box_area(tree->nodes[i].box);
+    }
+  }
+  tree->builtArea = tree->leafArea;
+}
+
+static void fit_leaf(CullTree* tree, CullNode* node)
+{
+  int i;
+  memcpy(node->box, tree->boxes + tree->order[node->first] * 6, sizeof(node->box));
+  for (i = 1; i < node->count; i++)
+  {
+    box_union(node->box, tree->boxes + tree->order[node->first + i] * 6);
+  }
+}
+
+/*
+ * @ brief Refit the leaf of a moved object and its ancestors, up to the first one that does not change.
+ */
+static void refit_path(CullTree* tree, int object)
+{
+  int node = tree->leaves[object];
+  CullNode* leaf = &tree->nodes[node];
+
+  tree->leafArea -= box_area(leaf->box);
+  fit_leaf(tree, leaf);
+  tree->leafArea += box_area(leaf->box);
+
+  for (node = tree->parents[node]; node >= 0; node = tree->parents[node])
+  {
+    CullNode* inner = &tree->nodes[node];
+    float box[6];
+
+    memcpy(box, tree->nodes[inner->left].box, sizeof(box));
+    box_union(box, tree->nodes[inner->left + 1].box);
+    if (memcmp(box, inner->box, sizeof(box)) == 0)
+    {
+      break;
+    }
+    memcpy(inner->box, box, sizeof(box));
+  }
+}
+
+/*
+ * @ brief Bring the node boxes up to date with the moved objects.
+ * @ details Many moves refit every node bottom up; children always follow their parent.
+ */
+static void refit(CullTree* tree)
+{
+  int i;
+
+  if (!tree->refitAll)
+  {
+    for (i = 0; i < tree->movedCount; i++)
+    {
+      refit_path(tree, tree->moved[i]);
+    }
+  }
+  else
+  {
+    tree->leafArea = 0.0f;
+    for (i = tree->nodeCount - 1; i >= 0; i--)
+    {
+      CullNode* node = &tree->nodes[i];
+      if (node->left < 0)
+      {
+        fit_leaf(tree, node);
+        tree->leafArea += box_area(node->box);
+      }
+      else
+      {
+        memcpy(node->box, tree->nodes[node->left].box, sizeof(node->box));
+        box_union(node->box, tree->nodes[node->left + 1].box);
+      }
+    }
+  }
+  tree->movedCount = 0;
+  tree->refitAll = 0;
+}
+
+/*
+ * @ brief Planes of the clip volume -w <= x, y, z <= w, a point is inside when
+ *         plane . (x, y, z, 1) >= 0 for all of them.
+ */
+static void frustum_planes(float planes[6][4], const float clip[16])
+{
+  int i, axis;
+  for (i = 0; i < 4; i++)
+  {
+    for (axis = 0; axis < 3; axis++)
+    {
+      planes[axis * 2][i] = clip[i * 4 + 3] + clip[i * 4 + axis];
+      planes[axis * 2 + 1][i] = clip[i * 4 + 3] - clip[i * 4 + axis];
+    }
+  }
+}
+
+static int append_objects(const CullTree* tree, const CullNode* node, int* visible, int visibleCount)
+{
+  memcpy(visible + visibleCount, tree->order + node->first, sizeof(int) * node->count);
+  return visibleCount + node->count;
+}
+
+/*
+ * @ brief Apply the pending updates, rebuilding when the refitted tree became too loose.
+ */
+static void prepare(CullTree* tree)
+{
+  if (tree->movedCount > 0 || tree->refitAll)
+  {
+    refit(tree);
+    if (tree->leafArea > tree->builtArea * CULL_REBUILD_GROWTH)
+    {
+      build(tree);
+    }
+  }
+}
+
+static int query_subtree(const CullTree* tree, int root, const float clip[16], int* visible)
+{
+  float planes[6][4];
+  int stackNode[CULL_STACK_SIZE];
+  int stackMask[CULL_STACK_SIZE];
+  int depth = 0;
+  int visibleCount = 0;
+
+  frustum_planes(planes, clip);
+
+  stackNode[depth] = root;
+  stackMask[depth] = CULL_ALL_PLANES;
+  depth++;
+  while (depth > 0)
+  {
+    const CullNode* node;
+    int mask, plane;
+    int outside = 0;
+
+    depth--;
+    node = &tree->nodes[stackNode[depth]];
+    mask = stackMask[depth];
+
+    /* Only planes the parent straddles are tested, a box inside a plane drops it for its subtree */
+    for (plane = 0; plane < 6 && !outside; plane++)
+    {
+      const float* p = planes[plane];
+      const float* box = node->box;
+      float farthest, nearest;
+
+      if (!(mask & (1 << plane)))
+      {
+        continue;
+      }
+      farthest = p[0] * box[p[0] >= 0.0f ? 3 : 0] + p[1] * box[p[1] >= 0.0f ? 4 : 1] +
+                 p[2] * box[p[2] >= 0.0f ? 5 : 2] + p[3];
+      if (farthest < 0.0f)
+      {
+        outside = 1;
+        break;
+      }
+      nearest = p[0] * box[p[0] >= 0.0f ? 0 : 3] + p[1] * box[p[1] >= 0.0f ? 1 : 4] +
+                p[2] * box[p[2] >= 0.0f ? 2 : 5] + p[3];
+      if (nearest >= 0.0f)
+      {
+        mask &= ~(1 << plane);
+      }
+    }
+
+    if (outside)
+    {
+      continue;
+    }
+    if (mask == 0 || node->left < 0)
+    {
+      /* Leaves are small enough that their objects are drawn without testing each one */
+      visibleCount = append_objects(tree, node, visible, visibleCount);
+      continue;
+    }
+
+    stackNode[depth] = node->left + 1;
+    stackMask[depth] = mask;
+    depth++;
+    stackNode[depth] = node->left;
+    stackMask[depth] = mask;
+    depth++;
+  }
+  return visibleCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CullTree* cull_tree_create(const float* boxes, int count)
+{
+  CullTree* tree = (CullTree*)calloc(1, sizeof(CullTree));
+  int i;
+
+  if (!tree)
+  {
+    return NULL;
+  }
+  tree->count = count > 0 ? count : 0;
+  /* A binary tree with at least one object per leaf has fewer than 2 * count nodes */
+  tree->nodes = (CullNode*)malloc(sizeof(CullNode) * (tree->count * 2 + 1));
+  tree->parents = (int*)malloc(sizeof(int) * (tree->count * 2 + 1));
+  tree->order = (int*)malloc(sizeof(int) * (tree->count + 1));
+  tree->leaves = (int*)malloc(sizeof(int) * (tree->count + 1));
+  tree->boxes = (float*)malloc(sizeof(float) * 6 * (tree->count + 1));
+  tree->moved = (int*)malloc(sizeof(int) * (tree->count / CULL_PATH_REFIT_RATIO + 1));
+  if (!tree->nodes || !tree->parents || !tree->order || !tree->leaves || !tree->boxes || !tree->moved)
+  {
+    cull_tree_destroy(tree);
+    return NULL;
+  }
+
+  memcpy(tree->boxes, boxes, sizeof(float) * 6 * tree->count);
+  for (i = 0; i < tree->count; i++)
+  {
+    tree->order[i] = i;
+  }
+  build(tree);
+  return tree;
+}
+
+void cull_tree_destroy(CullTree* tree)
+{
+  if (tree)
+  {
+    free(tree->nodes);
+    free(tree->parents);
+    free(tree->order);
+    free(tree->leaves);
+    free(tree->boxes);
+    free(tree->moved);
+    free(tree);
+  }
+}
+
+int cull_tree_count(const CullTree* tree)
+{
+  return tree->count;
+}
+
+void cull_tree_update(CullTree* tree, int index, const float box[6])
+{
+  if (index >= 0 && index < tree->count)
+  {
+    memcpy(tree->boxes + index * 6, box, sizeof(float) * 6);
+    if (tree->movedCount < tree->count / CULL_PATH_REFIT_RATIO)
+    {
+      tree->moved[tree->movedCount++] = index;
+    }
+    else
+    {
+      tree->refitAll = 1;
+    }
+  }
+}
+
+int cull_tree_query(CullTree* tree, const float clip[16], int* visible)
+{
+  if (tree->nodeCount == 0)
+  {
+    return 0;
+  }
+  prepare(tree);
+  return query_subtree(tree, 0, clip, visible);
+}
+
+int cull_tree_split(CullTree* tree, int maxRoots, int* roots, int* firsts)
+{
+  int rootCount = 1;
+  int i;
+
+  if (tree->nodeCount == 0 || maxRoots < 1)
+  {
+    return 0;
+  }
+  prepare(tree);
+
+  /* Replace every inner root by its children, in place from the back to keep tree order */
+  roots[0] = 0;
+  for (;;)
+  {
+    int splitCount = rootCount;
+    int write;
+    for (i = 0; i < rootCount; i++)
+    {
+      splitCount += tree->nodes[roots[i]].left >= 0;
+    }
+    if (splitCount == rootCount || splitCount > maxRoots)
+    {
+      break;
+    }
+    write = splitCount;
+    for (i = rootCount - 1; i >= 0; i--)
+    {
+      const CullNode* node = &tree->nodes[roots[i]];
+      if (node->left >= 0)
+      {
+        roots[--write] = node->left + 1;
+        roots[--write] = node->left;
+      }
+      else
+      {
+        roots[--write] = roots[i];
+      }
+    }
+    rootCount = splitCount;
+  }
+
+  for (i = 0; i < rootCount; i++)
+  {
+    firsts[i] = tree->nodes[roots[i]].first;
+  }
+  return rootCount;
+}
+
+int cull_tree_query_subtree(const CullTree* tree, int root, const float clip[16], int* visible)
+{
+  return query_subtree(tree, root, clip, visible);
+}
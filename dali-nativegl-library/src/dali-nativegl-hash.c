@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <GLES2/gl2.h>
+
+#include <dali-nativegl-hash_private.h>
+
+uint64_t hash_string(uint64_t hash, const char* value)
+{
+  const char* p = value ? value : "";
+  do
+  {
+    hash = (hash ^ (unsigned char)*p) * 1099511628211ull;
+  } while (*p++);
+  return hash;
+}
+
+uint64_t hash_driver(uint64_t hash)
+{
+  hash = hash_string(hash, (const char*)glGetString(GL_VENDOR));
+  hash = hash_string(hash, (const char*)glGetString(GL_RENDERER));
+  return hash_string(hash, (const char*)glGetString(GL_VERSION));
+}
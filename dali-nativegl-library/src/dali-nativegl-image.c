@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <zlib.h>
+#include <GLES2/gl2.h>
+
+#include <dlog.h>
+#include <dali-nativegl-library.h>
+#include <dali-nativegl-image_private.h>
+
+#define NATIVEGL_LOG_TAG "DALI_NATIVEGL_LIBRARY"
+
+/* Compressed bytes per IDAT chunk */
+#define PNG_CHUNK_SIZE 65536
+
+/* Frames waiting for the writer; beyond that it has fallen behind and new frames are dropped
+ * rather than piling up full size pixel copies */
+#define IMAGE_QUEUE_LIMIT 8
+
+typedef struct ImageWrite {
+    struct ImageWrite* next;
+    char*              path;
+    int                format;
+    unsigned char*     pixels;
+    int                width;
+    int                height;
+    ImageWriteStatus*  status;
+} ImageWrite;
+
+/* Queue of the writer thread, which runs until the process exits */
+static pthread_mutex_t sLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sQueued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t sIdle = PTHREAD_COND_INITIALIZER;
+static ImageWrite* sHead;
+static ImageWrite* sTail;
+static int sQueuedCount;
+static int sStarted;
+
+static void put_be32(unsigned char* bytes, unsigned int value);
+static int write_chunk(FILE* file, const char* type, const unsigned char* data, unsigned int size);
+static int deflate_chunks(FILE* file, z_stream* stream, unsigned char* chunk, int flush);
+static int write_png(FILE* file, const unsigned char* pixels, int width, int height);
+static void* writer_main(void* arg);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static void put_be32(unsigned char* bytes, unsigned int value)
+{
+  bytes[0] = (unsigned char)(value >> 24);
+  bytes[1] = (unsigned char)(value >> 16);
+  bytes[2] = (unsigned char)(value >> 8);
+  bytes[3] = (unsigned char)value;
+}
+
+static int write_chunk(FILE* file, const char* type, const unsigned char* data, unsigned int size)
+{
+  unsigned char header[8];
+  unsigned char footer[4];
+  uLong crc = crc32(0L, (const Bytef*)type, 4);
+
+  if (size > 0)
+  {
+    crc = crc32(crc, data, size);
+  }
+  put_be32(header, size);
+  memcpy(header + 4, type, 4);
+  put_be32(footer, (unsigned int)crc);
+  return fwrite(header, 1, 8, file) == 8 && (size == 0 || fwrite(data, 1, size, file) == size) &&
+         fwrite(footer, 1, 4, file) == 4;
+}
+
+/*
+ * @ brief Deflate the pending input into IDAT chunks of PNG_CHUNK_SIZE.
+ */
+static int deflate_chunks(FILE* file, z_stream* stream, unsigned char* chunk, int flush)
+{
+  int status;
+
+  do
+  {
+    status = deflate(stream, flush);
+    if (status == Z_STREAM_ERROR)
+    {
+      return 0;
+    }
+    if (stream->avail_out == 0 || status == Z_STREAM_END)
+    {
+      if (!write_chunk(file, "IDAT", chunk, PNG_CHUNK_SIZE - stream->avail_out))
+      {
+        return 0;
+      }
+      stream->next_out = chunk;
+      stream->avail_out = PNG_CHUNK_SIZE;
+    }
+  } while (stream->avail_in > 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+  return 1;
+}
+
+/*
+ * @ brief 8 bit RGBA PNG without row filters; flat shaded frames compress well enough and the
+ *         writer keeps up at Z_BEST_SPEED.
+ */
+static int write_png(FILE* file, const unsigned char* pixels, int width, int height)
+{
+  static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  const size_t rowSize = (size_t)width * 4;
+  unsigned char header[13];
+  unsigned char* chunk = (unsigned char*)malloc(PNG_CHUNK_SIZE);
+  unsigned char* line = (unsigned char*)malloc(rowSize + 1);
+  z_stream stream;
+  int ok, row;
+
+  memset(&stream, 0, sizeof(stream));
+  if (!chunk || !line || deflateInit(&stream, Z_BEST_SPEED) != Z_OK)
+  {
+    free(chunk);
+    free(line);
+    return 0;
+  }
+
+  put_be32(header, (unsigned int)width);
+  put_be32(header + 4, (unsigned int)height);
+  header[8] = 8;     /* Bits per channel */
+  header[9] = 6;     /* RGBA */
+  header[10] = 0;    /* Deflate */
+  header[11] = 0;    /* Per row filters, all rows use 0 (none) */
+  header[12] = 0;    /* Not interlaced */
+  ok = fwrite(signature, 1, 8, file) == 8 && write_chunk(file, "IHDR", header, sizeof(header));
+
+  stream.next_out = chunk;
+  stream.avail_out = PNG_CHUNK_SIZE;
+  line[0] = 0;
+  for (row = height - 1; ok && row >= 0; row--)
+  {
+    memcpy(line + 1, pixels + row * rowSize, rowSize);
+    stream.next_in = line;
+    stream.avail_in = (uInt)(rowSize + 1);
+    ok = deflate_chunks(file, &stream, chunk, Z_NO_FLUSH);
+  }
+  ok = ok && deflate_chunks(file, &stream, chunk, Z_FINISH);
+  deflateEnd(&stream);
+  free(chunk);
+  free(line);
+
+  return ok && write_chunk(file, "IEND", NULL, 0);
+}
+
+static void* writer_main(void* arg)
+{
+  (void)arg;
+  pthread_mutex_lock(&sLock);
+  for (;;)
+  {
+    ImageWrite* write;
+    int ok;
+
+    while (!sHead)
+    {
+      pthread_cond_wait(&sQueued, &sLock);
+    }
+    write = sHead;
+    sHead = write->next;
+    if (!sHead)
+    {
+      sTail = NULL;
+    }
+    sQueuedCount--;
+    pthread_mutex_unlock(&sLock);
+
+    ok = image_write(write->path, write->format, write->pixels, write->width, write->height);
+    free(write->path);
+    free(write->pixels);
+
+    pthread_mutex_lock(&sLock);
+    write->status->failed += !ok;
+    if (--write->status->pending == 0)
+    {
+      pthread_cond_broadcast(&sIdle);
+    }
+    free(write);
+  }
+  return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int image_write(const char* path, int format, const unsigned char* pixels, int width, int height)
+{
+  FILE* file = fopen(path, "wb");
+  int ok, row;
+
+  if (!file)
+  {
+    dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "cannot write %s\n", path);
+    return 0;
+  }
+
+  if (format == GL_CAPTURE_PNG)
+  {
+    ok = write_png(file, pixels, width, height);
+  }
+  else
+  {
+    ok = 1;
+    for (row = height - 1; ok && row >= 0; row--)
+    {
+      ok = fwrite(pixels + (size_t)row * width * 4, 4, width, file) == (size_t)width;
+    }
+  }
+
+  ok &= fclose(file) == 0;
+  if (!ok)
+  {
+    dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "cannot write %s\n", path);
+  }
+  return ok;
+}
+
+int image_queue_write(ImageWriteStatus* status, char* path, int format, unsigned char* pixels, int width, int height)
+{
+  ImageWrite* write = (ImageWrite*)malloc(sizeof(ImageWrite));
+  pthread_t thread;
+
+  pthread_mutex_lock(&sLock);
+  if (!sStarted)
+  {
+    if (pthread_create(&thread, NULL, writer_main, NULL) == 0)
+    {
+      pthread_detach(thread);
+      sStarted = 1;
+    }
+    else
+    {
+      dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "cannot start the image writer\n");
+    }
+  }
+  if (sQueuedCount >= IMAGE_QUEUE_LIMIT)
+  {
+    dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "image writer behind, dropping %s\n", path);
+  }
+  if (!write || !sStarted || sQueuedCount >= IMAGE_QUEUE_LIMIT)
+  {
+    status->failed++;
+    pthread_mutex_unlock(&sLock);
+    free(write);
+    free(path);
+    free(pixels);
+    return 0;
+  }
+
+  write->next = NULL;
+  write->path = path;
+  write->format = format;
+  write->pixels = pixels;
+  write->width = width;
+  write->height = height;
+  write->status = status;
+  status->pending++;
+  sQueuedCount++;
+  if (sTail)
+  {
+    sTail->next = write;
+  }
+  else
+  {
+    sHead = write;
+  }
+  sTail = write;
+  pthread_cond_signal(&sQueued);
+  pthread_mutex_unlock(&sLock);
+  return 1;
+}
+
+int image_wait_writes(ImageWriteStatus* status)
+{
+  int failed;
+
+  pthread_mutex_lock(&sLock);
+  while (status->pending)
+  {
+    pthread_cond_wait(&sIdle, &sLock);
+  }
+  failed = status->failed;
+  status->failed = 0;
+  pthread_mutex_unlock(&sLock);
+  return failed;
+}
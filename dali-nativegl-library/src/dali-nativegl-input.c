@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <time.h>
+
+#include <dali-nativegl-input_private.h>
+
+/*
+ * head and tail are free running counters, the slot is the counter modulo the ring size.
+ * Each side only writes its own counter: the release store publishes the slot contents, the
+ * acquire load of the other side's counter makes them visible before they are used.
+ */
+#define INPUT_QUEUE_MASK (GL_INPUT_QUEUE_SIZE - 1)
+
+#if (GL_INPUT_QUEUE_SIZE & INPUT_QUEUE_MASK) != 0
+#error "GL_INPUT_QUEUE_SIZE must be a power of two"
+#endif
+
+int input_queue_push(GLInputQueue* queue, InputEventType type, int x, int y)
+{
+  unsigned int head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+  unsigned int tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+  const int touch = type == INPUT_EVENT_TOUCH_DOWN || type == INPUT_EVENT_TOUCH_UP;
+  GLInputEvent* event;
+
+  if (head - tail >= (touch ? GL_INPUT_QUEUE_SIZE : GL_INPUT_QUEUE_SIZE - GL_INPUT_QUEUE_RESERVED))
+  {
+    if (touch)
+    {
+      /* Only the latest transition matters. The consumer takes it when its tail reaches head,
+       * after the events queued before it */
+      __atomic_store_n(&queue->lostTouch, (unsigned long long)(type + 1) << 32 | head, __ATOMIC_RELEASE);
+    }
+    else
+    {
+      __atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+    }
+    return 0;
+  }
+  if (touch)
+  {
+    /* Superseded, cleared before this event is published so it is never applied after it */
+    __atomic_store_n(&queue->lostTouch, 0, __ATOMIC_RELAXED);
+  }
+  else
+  {
+    /* Queue a kept touch first, unless the consumer took it already, so it stays ahead of
+     * this event and a later loss cannot move it behind events queued meanwhile */
+    unsigned long long lostTouch = __atomic_load_n(&queue->lostTouch, __ATOMIC_RELAXED);
+    if (lostTouch && (lostTouch = __atomic_exchange_n(&queue->lostTouch, 0, __ATOMIC_ACQUIRE)) != 0)
+    {
+      event = &queue->events[head & INPUT_QUEUE_MASK];
+      event->type = (int)(lostTouch >> 32) - 1;
+      event->x = 0;
+      event->y = 0;
+      event->time = input_time_ms();
+      head++;
+    }
+  }
+
+  event = &queue->events[head & INPUT_QUEUE_MASK];
+  event->type = type;
+  event->x = x;
+  event->y = y;
+  event->time = input_time_ms();
+  __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+int input_queue_pop(GLInputQueue* queue, GLInputEvent* event)
+{
+  unsigned int tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+  unsigned int head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+  /* Loaded after head: a touch kept aside before the event at tail was queued is seen here */
+  unsigned long long lostTouch = __atomic_load_n(&queue->lostTouch, __ATOMIC_ACQUIRE);
+
+  /* The producer may replace or clear it meanwhile, retry with what it wrote */
+  while (lostTouch && (unsigned int)lostTouch == tail)
+  {
+    if (__atomic_compare_exchange_n(&queue->lostTouch, &lostTouch, 0, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+    {
+      event->type = (int)(lostTouch >> 32) - 1;
+      event->x = 0;
+      event->y = 0;
+      event->time = input_time_ms();
+      return 1;
+    }
+  }
+
+  if (tail == head)
+  {
+    return 0;
+  }
+
+  *event = queue->events[tail & INPUT_QUEUE_MASK];
+  __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+unsigned int input_queue_dropped(GLInputQueue* queue)
+{
+  return __atomic_load_n(&queue->dropped, __ATOMIC_RELAXED);
+}
+
+double input_time_ms(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <dlog.h>
+#include <dali-nativegl-jobs_private.h>
+
+#define NATIVEGL_LOG_TAG "DALI_NATIVEGL_LIBRARY"
+
+#define JOBS_MAX_WORKERS 63
+#define JOBS_DEQUE_SIZE 256      /* Must be a power of two */
+#define JOBS_DEQUE_MASK (JOBS_DEQUE_SIZE - 1)
+
+/*
+ * Chase-Lev deque: the owner pushes and takes at the bottom, thieves take from the top.
+ * Ranges are packed as begin | end << 32 so a slot is read and written in one access.
+ * Halving ranges keeps at most log2(count) entries per deque, far below its size.
+ */
+typedef struct {
+    long long top;               /* Next range to steal, advanced by CAS */
+    char      topPadding[56];
+    long long bottom;            /* Next free slot, only written by the owner */
+    char      bottomPadding[56];
+    uint64_t  ranges[JOBS_DEQUE_SIZE];
+} JobDeque;
+
+typedef struct {
+    JobPool*  pool;
+    int       self;              /* Index of the worker's deque */
+    pthread_t thread;
+} JobWorker;
+
+/* Only the thread that owns the pool submits loops, so submitting takes no lock */
+struct JobPool {
+    /* Wakes the workers for a new loop, and idle threads for new ranges or the end of the loop */
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+    pthread_cond_t  idle;
+    unsigned int    epoch;
+    unsigned int    pushes;      /* Rounds of ranges pushed while a thread was idle */
+    int             sleepers;    /* Threads waiting on idle */
+    int             shutdown;
+
+    int             started;     /* The workers below are running */
+    unsigned int    generation;  /* sGeneration they were started for */
+    int             workerCount;
+    JobWorker       workers[JOBS_MAX_WORKERS];
+
+    /* Current loop, published before remaining */
+    JobFunction     function;
+    void*           data;
+    int             grain;
+    int             remaining;   /* Indices not finished yet */
+
+    JobDeque*       deques;      /* workerCount + 1, 0 belongs to the caller */
+};
+
+/* setWorkerThreadCount(), picked up by every pool before its next loop */
+static int sConfigured = -1;
+static unsigned int sGeneration;
+
+static uint64_t pack_range(int begin, int end);
+static int deque_push(JobDeque* deque, uint64_t range);
+static int deque_take(JobDeque* deque, uint64_t* range);
+static int deque_steal(JobDeque* deque, uint64_t* range);
+static int steal_any(JobPool* pool, int self, unsigned int* seed, uint64_t* range);
+static void split_range(JobPool* pool, int self, int* begin, int* end);
+static int finish_range(JobPool* pool, int count);
+static void run_range(JobPool* pool, int self, uint64_t range);
+static void wait_for_ranges(JobPool* pool, int self, unsigned int* seed);
+static void work(JobPool* pool, int self, unsigned int* seed);
+static void* worker_main(void* arg);
+static void start_workers(JobPool* pool);
+static void stop_workers(JobPool* pool);
+static JobPool* prepare_pool(JobPool** pool);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static uint64_t pack_range(int begin, int end)
+{
+  return (uint64_t)(uint32_t)begin | ((uint64_t)(uint32_t)end << 32);
+}
+
+static int deque_push(JobDeque* deque, uint64_t range)
+{
+  long long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+  long long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+
+  if (bottom - top >= JOBS_DEQUE_SIZE)
+  {
+    return 0;
+  }
+  __atomic_store_n(&deque->ranges[bottom & JOBS_DEQUE_MASK], range, __ATOMIC_RELAXED);
+  /* Publishes the range and the loop it belongs to */
+  __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+static int deque_take(JobDeque* deque, uint64_t* range)
+{
+  long long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+  long long top;
+  int taken = 1;
+
+  __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+  if (top > bottom)
+  {
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return 0;
+  }
+  *range = __atomic_load_n(&deque->ranges[bottom & JOBS_DEQUE_MASK], __ATOMIC_RELAXED);
+  if (top == bottom)
+  {
+    /* Last range, race the thieves for it */
+    taken = __atomic_compare_exchange_n(&deque->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+  }
+  return taken;
+}
+
+static int deque_steal(JobDeque* deque, uint64_t* range)
+{
+  long long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+  long long bottom;
+
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+  if (top >= bottom)
+  {
+    return 0;
+  }
+  *range = __atomic_load_n(&deque->ranges[top & JOBS_DEQUE_MASK], __ATOMIC_RELAXED);
+  return __atomic_compare_exchange_n(&deque->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+/*
+ * @ brief Try every other deque once, starting at a random one.
+ */
+static int steal_any(JobPool* pool, int self, unsigned int* seed, uint64_t* range)
+{
+  int count = pool->workerCount + 1;
+  int start, i;
+
+  *seed = *seed * 1103515245u + 12345u;
+  start = (int)((*seed >> 16) % (unsigned int)count);
+  for (i = 0; i < count; i++)
+  {
+    int victim = (start + i) % count;
+    if (victim != self && deque_steal(&pool->deques[victim], range))
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+ * @ brief Leave upper halves of [begin, end) to thieves until it is down to the grain size,
+ *         waking idle threads for them.
+ */
+static void split_range(JobPool* pool, int self, int* begin, int* end)
+{
+  int pushed = 0;
+
+  while (*end - *begin > pool->grain)
+  {
+    int middle = *begin + (*end - *begin) / 2;
+    if (!deque_push(&pool->deques[self], pack_range(middle, *end)))
+    {
+      break;
+    }
+    *end = middle;
+    pushed = 1;
+  }
+
+  /* Pairs with the fence in wait_for_ranges(): either the sleeper is counted here, or its
+   * last steal attempt sees the pushed ranges */
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (pushed && __atomic_load_n(&pool->sleepers, __ATOMIC_RELAXED) > 0)
+  {
+    pthread_mutex_lock(&pool->lock);
+    pool->pushes++;
+    pthread_cond_broadcast(&pool->idle);
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+/*
+ * @ brief Count finished indices, waking the idle threads when they were the last ones.
+ * @ return 1 when the loop is finished.
+ */
+static int finish_range(JobPool* pool, int count)
+{
+  if (__atomic_sub_fetch(&pool->remaining, count, __ATOMIC_ACQ_REL) != 0)
+  {
+    return 0;
+  }
+  pthread_mutex_lock(&pool->lock);
+  pthread_cond_broadcast(&pool->idle);
+  pthread_mutex_unlock(&pool->lock);
+  return 1;
+}
+
+/*
+ * @ brief Run a range after splitting it.
+ */
+static void run_range(JobPool* pool, int self, uint64_t range)
+{
+  int begin = (int)(uint32_t)range;
+  int end = (int)(uint32_t)(range >> 32);
+
+  split_range(pool, self, &begin, &end);
+  pool->function(pool->data, begin, end);
+  finish_range(pool, end - begin);
+}
+
+/*
+ * @ brief Nothing to take or steal: sleep until ranges are pushed or the loop is finished.
+ */
+static void wait_for_ranges(JobPool* pool, int self, unsigned int* seed)
+{
+  unsigned int seen;
+  uint64_t range;
+
+  pthread_mutex_lock(&pool->lock);
+  seen = pool->pushes;
+  __atomic_fetch_add(&pool->sleepers, 1, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&pool->lock);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  /* Ranges pushed before the sleeper was counted did not wake anyone, look once more */
+  if (steal_any(pool, self, seed, &range))
+  {
+    __atomic_fetch_sub(&pool->sleepers, 1, __ATOMIC_RELAXED);
+    run_range(pool, self, range);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  while (__atomic_load_n(&pool->remaining, __ATOMIC_ACQUIRE) > 0 && pool->pushes == seen)
+  {
+    pthread_cond_wait(&pool->idle, &pool->lock);
+  }
+  __atomic_fetch_sub(&pool->sleepers, 1, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+/*
+ * @ brief Run own and stolen ranges until the loop is finished.
+ */
+static void work(JobPool* pool, int self, unsigned int* seed)
+{
+  while (__atomic_load_n(&pool->remaining, __ATOMIC_ACQUIRE) > 0)
+  {
+    uint64_t range;
+    if (deque_take(&pool->deques[self], &range) || steal_any(pool, self, seed, &range))
+    {
+      run_range(pool, self, range);
+    }
+    else
+    {
+      wait_for_ranges(pool, self, seed);
+    }
+  }
+}
+
+static void* worker_main(void* arg)
+{
+  JobWorker* worker = (JobWorker*)arg;
+  JobPool* pool = worker->pool;
+  unsigned int seed = (unsigned int)worker->self;
+  unsigned int seen = 0;
+
+  for (;;)
+  {
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->shutdown && pool->epoch == seen)
+    {
+      pthread_cond_wait(&pool->wake, &pool->lock);
+    }
+    if (pool->shutdown)
+    {
+      pthread_mutex_unlock(&pool->lock);
+      return NULL;
+    }
+    seen = pool->epoch;
+    pthread_mutex_unlock(&pool->lock);
+
+    work(pool, worker->self, &seed);
+  }
+}
+
+/*
+ * @ brief Start the configured workers.
+ */
+static void start_workers(JobPool* pool)
+{
+  int count;
+
+  pool->generation = __atomic_load_n(&sGeneration, __ATOMIC_ACQUIRE);
+  count = __atomic_load_n(&sConfigured, __ATOMIC_RELAXED);
+  if (count < 0)
+  {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    count = cores > 1 ? (int)cores - 1 : 0;
+  }
+  if (count > JOBS_MAX_WORKERS)
+  {
+    count = JOBS_MAX_WORKERS;
+  }
+
+  pool->started = 1;
+  pool->workerCount = 0;
+  pool->epoch = 0;
+  if (count > 0 && posix_memalign((void**)&pool->deques, 64, sizeof(JobDeque) * (count + 1)) != 0)
+  {
+    pool->deques = NULL;
+    dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "cannot allocate %d job workers\n", count);
+    return;
+  }
+  if (pool->deques)
+  {
+    memset(pool->deques, 0, sizeof(JobDeque) * (count + 1));
+  }
+  while (pool->workerCount < count)
+  {
+    JobWorker* worker = &pool->workers[pool->workerCount];
+    worker->pool = pool;
+    worker->self = pool->workerCount + 1;
+    if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0)
+    {
+      dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "cannot start job worker %d of %d\n", pool->workerCount + 1, count);
+      break;
+    }
+    pool->workerCount++;
+  }
+}
+
+/*
+ * @ brief Stop and join the workers.
+ */
+static void stop_workers(JobPool* pool)
+{
+  int i;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown = 1;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+  for (i = 0; i < pool->workerCount; i++)
+  {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+  free(pool->deques);
+  pool->deques = NULL;
+  pool->shutdown = 0;
+  pool->workerCount = 0;
+  pool->started = 0;
+}
+
+/*
+ * @ brief Create the pool on first use and (re)start its workers when setWorkerThreadCount() changed.
+ * @ return The pool, or NULL when out of memory.
+ */
+static JobPool* prepare_pool(JobPool** pool)
+{
+  if (!*pool)
+  {
+    *pool = (JobPool*)calloc(1, sizeof(JobPool));
+    if (!*pool)
+    {
+      return NULL;
+    }
+    pthread_mutex_init(&(*pool)->lock, NULL);
+    pthread_cond_init(&(*pool)->wake, NULL);
+    pthread_cond_init(&(*pool)->idle, NULL);
+  }
+  if ((*pool)->started && (*pool)->generation != __atomic_load_n(&sGeneration, __ATOMIC_ACQUIRE))
+  {
+    stop_workers(*pool);
+  }
+  if (!(*pool)->started)
+  {
+    start_workers(*pool);
+  }
+  return *pool;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int jobs_set_worker_count(int count)
+{
+  if (count < -1 || count > JOBS_MAX_WORKERS)
+  {
+    return 0;
+  }
+  __atomic_store_n(&sConfigured, count, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&sGeneration, 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+int jobs_worker_count(JobPool** pool)
+{
+  JobPool* prepared = prepare_pool(pool);
+
+  return prepared ? prepared->workerCount : 0;
+}
+
+void jobs_parallel_for(JobPool** pool, JobFunction function, void* data, int count, int grain)
+{
+  JobPool* prepared = prepare_pool(pool);
+  unsigned int seed = 0;
+  int begin = 0;
+  int end = count;
+
+  if (count <= 0)
+  {
+    return;
+  }
+  if (grain < 1)
+  {
+    grain = 1;
+  }
+  if (!prepared || prepared->workerCount == 0 || count <= grain)
+  {
+    function(data, 0, count);
+    return;
+  }
+
+  prepared->function = function;
+  prepared->data = data;
+  prepared->grain = grain;
+  __atomic_store_n(&prepared->remaining, count, __ATOMIC_RELEASE);
+
+  /* Split before waking the workers, so they find ranges to steal instead of going idle */
+  split_range(prepared, 0, &begin, &end);
+  pthread_mutex_lock(&prepared->lock);
+  prepared->epoch++;
+  pthread_cond_broadcast(&prepared->wake);
+  pthread_mutex_unlock(&prepared->lock);
+
+  function(data, begin, end);
+  if (!finish_range(prepared, end - begin))
+  {
+    work(prepared, 0, &seed);
+  }
+}
+
+void jobs_destroy(JobPool** pool)
+{
+  if (*pool)
+  {
+    if ((*pool)->started)
+    {
+      stop_workers(*pool);
+    }
+    pthread_cond_destroy(&(*pool)->idle);
+    pthread_cond_destroy(&(*pool)->wake);
+    pthread_mutex_destroy(&(*pool)->lock);
+    free(*pool);
+    *pool = NULL;
+  }
+}
@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* sincosf */
+#endif
+
+#include <math.h>
+
+#include <dali-nativegl-matrix_private.h>
+
+/* Four float lanes, one matrix column. The algorithms below are written once against these helpers. */
+#if defined(__SSE__)
+#include <xmmintrin.h>
+typedef __m128 vec4;
+#define VEC4_NAME "sse"
+static inline vec4 vec4_load(const float* p) { return _mm_loadu_ps(p); }
+static inline void vec4_store(float* p, vec4 v) { _mm_storeu_ps(p, v); }
+static inline vec4 vec4_splat(float s) { return _mm_set1_ps(s); }
+static inline vec4 vec4_mul(vec4 a, vec4 b) { return _mm_mul_ps(a, b); }
+static inline vec4 vec4_madd(vec4 acc, vec4 a, vec4 b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+typedef float32x4_t vec4;
+#define VEC4_NAME "neon"
+static inline vec4 vec4_load(const float* p) { return vld1q_f32(p); }
+static inline void vec4_store(float* p, vec4 v) { vst1q_f32(p, v); }
+static inline vec4 vec4_splat(float s) { return vdupq_n_f32(s); }
+static inline vec4 vec4_mul(vec4 a, vec4 b) { return vmulq_f32(a, b); }
+static inline vec4 vec4_madd(vec4 acc, vec4 a, vec4 b) { return vmlaq_f32(acc, a, b); }
+#else
+typedef struct { float v[4]; } vec4;
+#define VEC4_NAME "scalar"
+static inline vec4 vec4_load(const float* p) { vec4 r = { { p[0], p[1], p[2], p[3] } }; return r; }
+static inline void vec4_store(float* p, vec4 v) { p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3]; }
+static inline vec4 vec4_splat(float s) { vec4 r = { { s, s, s, s } }; return r; }
+static inline vec4 vec4_mul(vec4 a, vec4 b)
+{
+  vec4 r = { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } };
+  return r;
+}
+static inline vec4 vec4_madd(vec4 acc, vec4 a, vec4 b)
+{
+  vec4 r = { { acc.v[0] + a.v[0] * b.v[0], acc.v[1] + a.v[1] * b.v[1], acc.v[2] + a.v[2] * b.v[2], acc.v[3] + a.v[3] * b.v[3] } };
+  return r;
+}
+#endif
+
+#define DEGREE_TO_RADIAN 0.017453292519943295f
+
+/* 1 + from . to below which quaternion_between() treats the vectors as opposite */
+#define QUATERNION_OPPOSITE 1e-6f
+
+/*
+ * @ brief One result column: c0 * v[0] + c1 * v[1] + c2 * v[2] + c3 * v[3]
+ */
+static inline vec4 combine_columns(vec4 c0, vec4 c1, vec4 c2, vec4 c3, const float v[4])
+{
+  vec4 r = vec4_mul(c0, vec4_splat(v[0]));
+  r = vec4_madd(r, c1, vec4_splat(v[1]));
+  r = vec4_madd(r, c2, vec4_splat(v[2]));
+  return vec4_madd(r, c3, vec4_splat(v[3]));
+}
+
+const char* matrix_simd_name(void)
+{
+  return VEC4_NAME;
+}
+
+void matrix_identity(float matrix[16])
+{
+  static const float identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+  };
+  int i;
+  for (i = 0; i < 16; i++)
+  {
+    matrix[i] = identity[i];
+  }
+}
+
+void matrix_multiply(float matrix[16], const float matrix0[16], const float matrix1[16])
+{
+  vec4 c0 = vec4_load(matrix0);
+  vec4 c1 = vec4_load(matrix0 + 4);
+  vec4 c2 = vec4_load(matrix0 + 8);
+  vec4 c3 = vec4_load(matrix0 + 12);
+  /* Every input is read before the first store, so matrix may alias either input */
+  vec4 r0 = combine_columns(c0, c1, c2, c3, matrix1);
+  vec4 r1 = combine_columns(c0, c1, c2, c3, matrix1 + 4);
+  vec4 r2 = combine_columns(c0, c1, c2, c3, matrix1 + 8);
+  vec4 r3 = combine_columns(c0, c1, c2, c3, matrix1 + 12);
+
+  vec4_store(matrix, r0);
+  vec4_store(matrix + 4, r1);
+  vec4_store(matrix + 8, r2);
+  vec4_store(matrix + 12, r3);
+}
+
+void matrix_multiply_batch(float* result, const float matrix0[16], const float* matrices, int count)
+{
+  vec4 c0 = vec4_load(matrix0);
+  vec4 c1 = vec4_load(matrix0 + 4);
+  vec4 c2 = vec4_load(matrix0 + 8);
+  vec4 c3 = vec4_load(matrix0 + 12);
+  int i;
+
+  for (i = 0; i < count; i++, result += 16, matrices += 16)
+  {
+    vec4 r0 = combine_columns(c0, c1, c2, c3, matrices);
+    vec4 r1 = combine_columns(c0, c1, c2, c3, matrices + 4);
+    vec4 r2 = combine_columns(c0, c1, c2, c3, matrices + 8);
+    vec4 r3 = combine_columns(c0, c1, c2, c3, matrices + 12);
+    vec4_store(result, r0);
+    vec4_store(result + 4, r1);
+    vec4_store(result + 8, r2);
+    vec4_store(result + 12, r3);
+  }
+}
+
+void matrix_rotation_xyz(float result[16], const float anglex, const float angley, const float anglez)
+{
+  float sx, cx, sy, cy, sz, cz;
+
+  sincosf(anglex * DEGREE_TO_RADIAN, &sx, &cx);
+  sincosf(angley * DEGREE_TO_RADIAN, &sy, &cy);
+  sincosf(anglez * DEGREE_TO_RADIAN, &sz, &cz);
+
+  result[0] = cy * cz - sx * sy * sz;
+  result[1] = cz * sx * sy + cy * sz;
+  result[2] = -cx * sy;
+  result[3] = 0.0f;
+
+  result[4] = -cx * sz;
+  result[5] = cx * cz;
+  result[6] = sx;
+  result[7] = 0.0f;
+
+  result[8] = cz * sy + cy * sx * sz;
+  result[9] = -cy * cz * sx + sy * sz;
+  result[10] = cx * cy;
+  result[11] = 0.0f;
+
+  result[12] = 0.0f;
+  result[13] = 0.0f;
+  result[14] = 0.0f;
+  result[15] = 1.0f;
+}
+
+void matrix_rotate_xyz(float matrix[16], const float anglex, const float angley, const float anglez)
+{
+  float rotation[16];
+  vec4 c0 = vec4_load(matrix);
+  vec4 c1 = vec4_load(matrix + 4);
+  vec4 c2 = vec4_load(matrix + 8);
+  vec4 zero = vec4_splat(0.0f);
+  vec4 r0, r1, r2;
+
+  matrix_rotation_xyz(rotation, anglex, angley, anglez);
+
+  /* The rotation has no translation and w row (0, 0, 0, 1), column 3 of matrix is unchanged */
+  r0 = combine_columns(c0, c1, c2, zero, rotation);
+  r1 = combine_columns(c0, c1, c2, zero, rotation + 4);
+  r2 = combine_columns(c0, c1, c2, zero, rotation + 8);
+  vec4_store(matrix, r0);
+  vec4_store(matrix + 4, r1);
+  vec4_store(matrix + 8, r2);
+}
+
+void matrix_transform_points(float* result, int resultStride, const float matrix[16],
+                             const float* points, int pointStride, int count)
+{
+  vec4 c0 = vec4_load(matrix);
+  vec4 c1 = vec4_load(matrix + 4);
+  vec4 c2 = vec4_load(matrix + 8);
+  vec4 c3 = vec4_load(matrix + 12);
+  int i;
+
+  for (i = 0; i < count; i++, result += resultStride, points += pointStride)
+  {
+    vec4 r = vec4_madd(c3, c0, vec4_splat(points[0]));
+    r = vec4_madd(r, c1, vec4_splat(points[1]));
+    r = vec4_madd(r, c2, vec4_splat(points[2]));
+    vec4_store(result, r);
+  }
+}
+
+int matrix_ortho(float result[16], const float left, const float right,
+                 const float bottom, const float top, const float near, const float far)
+{
+  if ((right - left) == 0.0f || (top - bottom) == 0.0f || (far - near) == 0.0f)
+  {
+    return 0;
+  }
+
+  matrix_identity(result);
+  result[0] = 2.0f / (right - left);
+  result[5] = 2.0f / (top - bottom);
+  result[10] = -2.0f / (far - near);
+  result[12] = -(right + left) / (right - left);
+  result[13] = -(top + bottom) / (top - bottom);
+  result[14] = -(far + near) / (far - near);
+
+  return 1;
+}
+
+int matrix_frustum(float result[16], const float left, const float right,
+                   const float bottom, const float top, const float near, const float far)
+{
+  if ((right - left) == 0.0f || (top - bottom) == 0.0f || (far - near) == 0.0f || near <= 0.0f)
+  {
+    return 0;
+  }
+
+  matrix_identity(result);
+  result[0] = 2.0f * near / (right - left);
+  result[5] = 2.0f * near / (top - bottom);
+  result[8] = (right + left) / (right - left);
+  result[9] = (top + bottom) / (top - bottom);
+  result[10] = -(far + near) / (far - near);
+  result[11] = -1.0f;
+  result[14] = -2.0f * far * near / (far - near);
+  result[15] = 0.0f;
+
+  return 1;
+}
+
+void quaternion_rotation(float result[4], const float x, const float y, const float z, const float degrees)
+{
+  float s, c;
+
+  sincosf(degrees * 0.5f * DEGREE_TO_RADIAN, &s, &c);
+  result[0] = x * s;
+  result[1] = y * s;
+  result[2] = z * s;
+  result[3] = c;
+}
+
+void quaternion_between(float result[4], const float from[3], const float to[3])
+{
+  const float dot = from[0] * to[0] + from[1] * to[1] + from[2] * to[2];
+
+  if (dot < QUATERNION_OPPOSITE - 1.0f)
+  {
+    /* Opposite: the cross product vanishes, half turn around an axis perpendicular to from,
+     * from x (1, 0, 0) unless from is close to that axis, then from x (0, 1, 0) */
+    if (fabsf(from[0]) < 0.9f)
+    {
+      result[0] = 0.0f;
+      result[1] = from[2];
+      result[2] = -from[1];
+    }
+    else
+    {
+      result[0] = -from[2];
+      result[1] = 0.0f;
+      result[2] = from[0];
+    }
+    result[3] = 0.0f;
+    quaternion_normalize(result);
+    return;
+  }
+
+  /* (from x to, from . to) rotates by twice the angle, adding the identity halves it */
+  result[0] = from[1] * to[2] - from[2] * to[1];
+  result[1] = from[2] * to[0] - from[0] * to[2];
+  result[2] = from[0] * to[1] - from[1] * to[0];
+  result[3] = 1.0f + dot;
+  quaternion_normalize(result);
+}
+
+void quaternion_multiply(float result[4], const float quaternion0[4], const float quaternion1[4])
+{
+  const float x0 = quaternion0[0], y0 = quaternion0[1], z0 = quaternion0[2], w0 = quaternion0[3];
+  const float x1 = quaternion1[0], y1 = quaternion1[1], z1 = quaternion1[2], w1 = quaternion1[3];
+
+  result[0] = w0 * x1 + x0 * w1 + y0 * z1 - z0 * y1;
+  result[1] = w0 * y1 - x0 * z1 + y0 * w1 + z0 * x1;
+  result[2] = w0 * z1 + x0 * y1 - y0 * x1 + z0 * w1;
+  result[3] = w0 * w1 - x0 * x1 - y0 * y1 - z0 * z1;
+}
+
+void quaternion_normalize(float quaternion[4])
+{
+  const float length = sqrtf(quaternion[0] * quaternion[0] + quaternion[1] * quaternion[1] +
+                             quaternion[2] * quaternion[2] + quaternion[3] * quaternion[3]);
+  int i;
+
+  if (length <= 0.0f)
+  {
+    quaternion[0] = 0.0f;
+    quaternion[1] = 0.0f;
+    quaternion[2] = 0.0f;
+    quaternion[3] = 1.0f;
+    return;
+  }
+  for (i = 0; i < 4; i++)
+  {
+    quaternion[i] /= length;
+  }
+}
+
+void matrix_from_quaternion(float result[16], const float quaternion[4])
+{
+  const float x = quaternion[0], y = quaternion[1], z = quaternion[2], w = quaternion[3];
+
+  result[0] = 1.0f - 2.0f * (y * y + z * z);
+  result[1] = 2.0f * (x * y + z * w);
+  result[2] = 2.0f * (x * z - y * w);
+  result[3] = 0.0f;
+
+  result[4] = 2.0f * (x * y - z * w);
+  result[5] = 1.0f - 2.0f * (x * x + z * z);
+  result[6] = 2.0f * (y * z + x * w);
+  result[7] = 0.0f;
+
+  result[8] = 2.0f * (x * z + y * w);
+  result[9] = 2.0f * (y * z - x * w);
+  result[10] = 1.0f - 2.0f * (x * x + y * y);
+  result[11] = 0.0f;
+
+  result[12] = 0.0f;
+  result[13] = 0.0f;
+  result[14] = 0.0f;
+  result[15] = 1.0f;
+}
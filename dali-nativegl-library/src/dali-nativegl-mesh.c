@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <GLES3/gl3.h>
+
+#include <dali-nativegl-mesh_private.h>
+
+static void pack_vertex(unsigned char* dst, const float* src, MeshFormat format);
+static unsigned int hash_vertex(const unsigned char* vertex, int stride);
+static int indices_in_range(const void* indices, int indexCount, int indexSize, int vertexCount);
+static size_t align_offset(size_t offset);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+/*
+ * @ brief Pack one x, y, z, r, g, b float vertex.
+ */
+static void pack_vertex(unsigned char* dst, const float* src, MeshFormat format)
+{
+  int colorOffset = mesh_format_color_offset(format);
+  int i;
+
+  memset(dst, 0, mesh_format_stride(format));
+  if (format == MESH_FORMAT_HALF_FLOAT)
+  {
+    unsigned short half[3];
+    for (i = 0; i < 3; i++)
+    {
+      half[i] = mesh_float_to_half(src[i]);
+    }
+    memcpy(dst, half, sizeof(half));
+  }
+  else
+  {
+    memcpy(dst, src, sizeof(float) * 3);
+  }
+
+  for (i = 0; i < 3; i++)
+  {
+    float c = src[3 + i];
+    c = c < 0.0f ? 0.0f : (c > 1.0f ? 1.0f : c);
+    dst[colorOffset + i] = (unsigned char)(c * 255.0f + 0.5f);
+  }
+  dst[colorOffset + 3] = 255;
+}
+
+/*
+ * @ brief FNV-1a over the packed bytes.
+ */
+static unsigned int hash_vertex(const unsigned char* vertex, int stride)
+{
+  unsigned int hash = 2166136261u;
+  int i;
+  for (i = 0; i < stride; i++)
+  {
+    hash = (hash ^ vertex[i]) * 16777619u;
+  }
+  return hash;
+}
+
+/*
+ * @ brief Check that every index addresses one of vertexCount vertices.
+ */
+static int indices_in_range(const void* indices, int indexCount, int indexSize, int vertexCount)
+{
+  unsigned int limit = (unsigned int)vertexCount;
+  unsigned int largest = 0;
+  int i;
+
+  for (i = 0; i < indexCount; i++)
+  {
+    unsigned int index;
+    if (indexSize == 1)
+    {
+      index = ((const unsigned char*)indices)[i];
+    }
+    else if (indexSize == 2)
+    {
+      index = ((const unsigned short*)indices)[i];
+    }
+    else
+    {
+      index = ((const unsigned int*)indices)[i];
+    }
+    largest = index > largest ? index : largest;
+  }
+  return indexCount == 0 || largest < limit;
+}
+
+static size_t align_offset(size_t offset)
+{
+  return (offset + MESH_FILE_ALIGNMENT - 1) & ~(size_t)(MESH_FILE_ALIGNMENT - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int mesh_format_stride(MeshFormat format)
+{
+  return format == MESH_FORMAT_HALF_FLOAT ? 12 : 16;
+}
+
+int mesh_format_color_offset(MeshFormat format)
+{
+  return format == MESH_FORMAT_HALF_FLOAT ? 8 : 12;
+}
+
+unsigned short mesh_float_to_half(float value)
+{
+  union { float f; unsigned int u; } bits;
+  unsigned int sign, exponent, mantissa, half, remainder;
+  int e;
+
+  bits.f = value;
+  sign = (bits.u >> 16) & 0x8000;
+  exponent = (bits.u >> 23) & 0xff;
+  mantissa = bits.u & 0x7fffff;
+
+  if (exponent == 0xff)
+  {
+    /* Inf stays Inf, NaN stays a quiet NaN */
+    return (unsigned short)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+  }
+
+  e = (int)exponent - 127 + 15;
+  if (e >= 0x1f)
+  {
+    return (unsigned short)(sign | 0x7c00);
+  }
+
+  if (e <= 0)
+  {
+    /* Subnormal half, or zero when too small */
+    unsigned int shift;
+    if (e < -10)
+    {
+      return (unsigned short)sign;
+    }
+    mantissa |= 0x800000;
+    shift = (unsigned int)(14 - e);
+    half = mantissa >> shift;
+    remainder = mantissa & ((1u << shift) - 1);
+    if (remainder > (1u << (shift - 1)) || (remainder == (1u << (shift - 1)) && (half & 1)))
+    {
+      half++;
+    }
+    return (unsigned short)(sign | half);
+  }
+
+  half = ((unsigned int)e << 10) | (mantissa >> 13);
+  remainder = mantissa & 0x1fff;
+  /* A carry out of the mantissa correctly bumps the exponent */
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+  {
+    half++;
+  }
+  return (unsigned short)(sign | half);
+}
+
+float mesh_half_to_float(unsigned short value)
+{
+  union { float f; unsigned int u; } bits;
+  unsigned int sign = (unsigned int)(value & 0x8000) << 16;
+  unsigned int exponent = (value >> 10) & 0x1f;
+  unsigned int mantissa = value & 0x3ff;
+
+  if (exponent == 0x1f)
+  {
+    bits.u = sign | 0x7f800000 | (mantissa << 13);
+  }
+  else if (exponent == 0)
+  {
+    /* Zero or subnormal, exact in single precision */
+    bits.f = mantissa * (1.0f / 16777216.0f);
+    bits.u |= sign;
+  }
+  else
+  {
+    bits.u = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  }
+  return bits.f;
+}
+
+void mesh_bounds(const Mesh* mesh, float box[6])
+{
+  int stride = mesh_format_stride(mesh->format);
+  int i, axis;
+
+  for (axis = 0; axis < 3; axis++)
+  {
+    box[axis] = 0.0f;
+    box[axis + 3] = 0.0f;
+  }
+  for (i = 0; i < mesh->vertexCount; i++)
+  {
+    const unsigned char* vertex = mesh->vertices + (size_t)i * stride;
+    for (axis = 0; axis < 3; axis++)
+    {
+      float value;
+      if (mesh->format == MESH_FORMAT_HALF_FLOAT)
+      {
+        unsigned short half;
+        memcpy(&half, vertex + axis * sizeof(half), sizeof(half));
+        value = mesh_half_to_float(half);
+      }
+      else
+      {
+        memcpy(&value, vertex + axis * sizeof(value), sizeof(value));
+      }
+      if (i == 0 || value < box[axis])
+      {
+        box[axis] = value;
+      }
+      if (i == 0 || value > box[axis + 3])
+      {
+        box[axis + 3] = value;
+      }
+    }
+  }
+}
+
+int mesh_create_indexed(Mesh* mesh, const float* vertices, int vertexCount, MeshFormat format)
+{
+  int stride = mesh_format_stride(format);
+  int capacity = 16;
+  int uniqueCount = 0;
+  int i;
+  unsigned char* packed;
+  unsigned int* indices;
+  int* table;
+  unsigned char candidate[16];
+
+  memset(mesh, 0, sizeof(*mesh));
+  while (capacity < vertexCount * 2)
+  {
+    capacity <<= 1;
+  }
+
+  /* The indices get a block of their own, narrowed in place at the end */
+  mesh->storage = malloc((size_t)vertexCount * stride);
+  mesh->indexStorage = malloc((size_t)vertexCount * sizeof(unsigned int));
+  table = (int*)malloc(sizeof(int) * capacity);
+  if (!mesh->storage || !mesh->indexStorage || !table)
+  {
+    free(mesh->storage);
+    free(mesh->indexStorage);
+    free(table);
+    mesh->storage = NULL;
+    mesh->indexStorage = NULL;
+    return 0;
+  }
+  packed = (unsigned char*)mesh->storage;
+  indices = (unsigned int*)mesh->indexStorage;
+  memset(table, 0, sizeof(int) * capacity);
+
+  for (i = 0; i < vertexCount; i++)
+  {
+    unsigned int slot;
+
+    pack_vertex(candidate, vertices + i * 6, format);
+    slot = hash_vertex(candidate, stride) & (capacity - 1);
+    /* Open addressing, entries store unique index + 1 */
+    while (table[slot] && memcmp(packed + (table[slot] - 1) * stride, candidate, stride) != 0)
+    {
+      slot = (slot + 1) & (capacity - 1);
+    }
+    if (!table[slot])
+    {
+      memcpy(packed + uniqueCount * stride, candidate, stride);
+      table[slot] = ++uniqueCount;
+    }
+    indices[i] = table[slot] - 1;
+  }
+  free(table);
+
+  /* Narrow the indices, every write lands at or before the index it was read from */
+  mesh->indexSize = uniqueCount <= 0x100 ? 1 : (uniqueCount <= 0x10000 ? 2 : 4);
+  if (mesh->indexSize < 4)
+  {
+    unsigned char* dst = (unsigned char*)mesh->indexStorage;
+    for (i = 0; i < vertexCount; i++)
+    {
+      unsigned int index = indices[i];
+      if (mesh->indexSize == 1)
+      {
+        dst[i] = (unsigned char)index;
+      }
+      else
+      {
+        unsigned short value = (unsigned short)index;
+        memcpy(dst + i * 2, &value, 2);
+      }
+    }
+  }
+  mesh->indices = mesh->indexStorage;
+
+  mesh->format = format;
+  mesh->vertices = packed;
+  mesh->vertexCount = uniqueCount;
+  mesh->indexCount = vertexCount;
+  return 1;
+}
+
+int mesh_load_file(Mesh* mesh, const char* path)
+{
+  const MeshFileHeader* header;
+  struct stat st;
+  size_t vertexBytes, indexBytes;
+  void* mapping;
+  int fd;
+
+  memset(mesh, 0, sizeof(*mesh));
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    return 0;
+  }
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MeshFileHeader))
+  {
+    close(fd);
+    return 0;
+  }
+  mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  /* The mapping keeps its own reference to the file */
+  close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    return 0;
+  }
+  mesh->mapping = mapping;
+  mesh->mappingSize = (size_t)st.st_size;
+
+  header = (const MeshFileHeader*)mapping;
+  if (memcmp(header->magic, MESH_FILE_MAGIC, 4) != 0 || header->version != MESH_FILE_VERSION ||
+      (header->format != MESH_FORMAT_FLOAT && header->format != MESH_FORMAT_HALF_FLOAT) ||
+      (header->indexSize != 1 && header->indexSize != 2 && header->indexSize != 4) ||
+      header->vertexCount > 0x7fffffff || header->indexCount > 0x7fffffff || header->indexCount % 3 != 0 ||
+      header->vertexOffset % MESH_FILE_ALIGNMENT != 0 || header->indexOffset % MESH_FILE_ALIGNMENT != 0)
+  {
+    mesh_destroy(mesh);
+    return 0;
+  }
+
+  vertexBytes = (size_t)header->vertexCount * mesh_format_stride((MeshFormat)header->format);
+  indexBytes = (size_t)header->indexCount * header->indexSize;
+  if (header->vertexOffset < sizeof(MeshFileHeader) || header->indexOffset < sizeof(MeshFileHeader) ||
+      header->vertexOffset > mesh->mappingSize || vertexBytes > mesh->mappingSize - header->vertexOffset ||
+      header->indexOffset > mesh->mappingSize || indexBytes > mesh->mappingSize - header->indexOffset)
+  {
+    mesh_destroy(mesh);
+    return 0;
+  }
+
+  mesh->format = (MeshFormat)header->format;
+  mesh->vertices = (const unsigned char*)mapping + header->vertexOffset;
+  mesh->vertexCount = (int)header->vertexCount;
+  mesh->indices = (const unsigned char*)mapping + header->indexOffset;
+  mesh->indexCount = (int)header->indexCount;
+  mesh->indexSize = (int)header->indexSize;
+
+  if (!indices_in_range(mesh->indices, mesh->indexCount, mesh->indexSize, mesh->vertexCount))
+  {
+    mesh_destroy(mesh);
+    return 0;
+  }
+  return 1;
+}
+
+int mesh_write_file(const Mesh* mesh, const char* path)
+{
+  static const unsigned char padding[MESH_FILE_ALIGNMENT] = { 0 };
+  MeshFileHeader header;
+  size_t vertexBytes = mesh_vertex_bytes(mesh);
+  size_t indexBytes = mesh_index_bytes(mesh);
+  size_t vertexOffset = align_offset(sizeof(header));
+  size_t indexOffset = align_offset(vertexOffset + vertexBytes);
+  FILE* file;
+  int ok;
+
+  if (indexOffset > 0xffffffffu)
+  {
+    return 0;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MESH_FILE_MAGIC, 4);
+  header.version = MESH_FILE_VERSION;
+  header.format = (uint32_t)mesh->format;
+  header.vertexCount = (uint32_t)mesh->vertexCount;
+  header.indexCount = (uint32_t)mesh->indexCount;
+  header.indexSize = (uint32_t)mesh->indexSize;
+  header.vertexOffset = (uint32_t)vertexOffset;
+  header.indexOffset = (uint32_t)indexOffset;
+
+  file = fopen(path, "wb");
+  if (!file)
+  {
+    return 0;
+  }
+  ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+       fwrite(padding, 1, vertexOffset - sizeof(header), file) == vertexOffset - sizeof(header) &&
+       fwrite(mesh->vertices, 1, vertexBytes, file) == vertexBytes &&
+       fwrite(padding, 1, indexOffset - vertexOffset - vertexBytes, file) == indexOffset - vertexOffset - vertexBytes &&
+       fwrite(mesh->indices, 1, indexBytes, file) == indexBytes;
+  if (fclose(file) != 0)
+  {
+    ok = 0;
+  }
+  return ok;
+}
+
+void mesh_destroy(Mesh* mesh)
+{
+  if (mesh->mapping)
+  {
+    munmap(mesh->mapping, mesh->mappingSize);
+  }
+  free(mesh->storage);
+  free(mesh->indexStorage);
+  memset(mesh, 0, sizeof(*mesh));
+}
+
+size_t mesh_vertex_bytes(const Mesh* mesh)
+{
+  return (size_t)mesh->vertexCount * mesh_format_stride(mesh->format);
+}
+
+size_t mesh_index_bytes(const Mesh* mesh)
+{
+  return (size_t)mesh->indexCount * mesh->indexSize;
+}
+
+unsigned int mesh_index_type(int indexSize)
+{
+  return indexSize == 1 ? GL_UNSIGNED_BYTE : (indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+}
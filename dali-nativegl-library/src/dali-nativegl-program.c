@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <dlog.h>
+#include <dali-nativegl-program_private.h>
+#include <dali-nativegl-resource_private.h>
+#include <dali-nativegl-hash_private.h>
+
+#define NATIVEGL_LOG_TAG "DALI_NATIVEGL_LIBRARY"
+
+/*
+ * Cache entry: <directory>/<key>.bin holding this header and the program binary. The key
+ * covers the sources, attribute bindings and driver strings, so any change misses.
+ */
+#define PROGRAM_CACHE_MAGIC "DNGP"
+#define PROGRAM_CACHE_VERSION 1
+
+typedef struct {
+  char     magic[4];
+  uint32_t version;
+  uint64_t key;
+  uint32_t binaryFormat;
+  uint32_t length;
+} ProgramCacheHeader;
+
+static char* sCacheDirectory;
+
+static uint64_t program_key(const char* vtxSource, const char* fgmtSource, const ProgramAttrib* attribs, int attribCount);
+static void cache_path(char* path, size_t size, uint64_t key);
+static GLuint load_cached_program(GLResourceRegistry* resources, uint64_t key);
+static void store_cached_program(GLuint program, uint64_t key);
+static GLuint compile_shader(GLResourceRegistry* resources, GLenum type, const char* source);
+static int check_link(GLuint program);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static uint64_t program_key(const char* vtxSource, const char* fgmtSource, const ProgramAttrib* attribs, int attribCount)
+{
+  uint64_t hash = hash_driver(HASH_SEED);
+  char index[16];
+  int i;
+
+  hash = hash_string(hash, vtxSource);
+  hash = hash_string(hash, fgmtSource);
+  for (i = 0; i < attribCount; i++)
+  {
+    snprintf(index, sizeof(index), "%u", attribs[i].index);
+    hash = hash_string(hash, index);
+    hash = hash_string(hash, attribs[i].name);
+  }
+  return hash;
+}
+
+static void cache_path(char* path, size_t size, uint64_t key)
+{
+  snprintf(path, size, "%s/%016llx.bin", sCacheDirectory, (unsigned long long)key);
+}
+
+/*
+ * @ brief Create a program from the cache entry of key, 0 on a miss.
+ * @ details An entry the driver rejects (e.g. after an update with the same version string)
+ *          is removed so it is replaced by the next store.
+ */
+static GLuint load_cached_program(GLResourceRegistry* resources, uint64_t key)
+{
+  char path[4096];
+  ProgramCacheHeader header;
+  void* binary = NULL;
+  GLuint program = 0;
+  FILE* file;
+
+  cache_path(path, sizeof(path), key);
+  file = fopen(path, "rb");
+  if (!file)
+  {
+    return 0;
+  }
+
+  if (fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, PROGRAM_CACHE_MAGIC, 4) == 0 &&
+      header.version == PROGRAM_CACHE_VERSION && header.key == key && header.length > 0 &&
+      (binary = malloc(header.length)) != NULL && fread(binary, 1, header.length, file) == header.length)
+  {
+    program = program_load_binary(resources, header.binaryFormat, binary, header.length);
+  }
+  fclose(file);
+  free(binary);
+
+  if (!program)
+  {
+    unlink(path);
+  }
+  return program;
+}
+
+/*
+ * @ brief Store the binary of a linked program, written to a temporary file and renamed so
+ *         a concurrent reader never sees a partial entry.
+ */
+static void store_cached_program(GLuint program, uint64_t key)
+{
+  char path[4096];
+  char temporary[4096 + 32];
+  ProgramCacheHeader header;
+  size_t written = 0;
+  GLenum binaryFormat = 0;
+  void* binary;
+  FILE* file;
+  int ok;
+
+  binary = program_get_binary(program, &binaryFormat, &written);
+  if (!binary)
+  {
+    return;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, PROGRAM_CACHE_MAGIC, 4);
+  header.version = PROGRAM_CACHE_VERSION;
+  header.key = key;
+  header.binaryFormat = binaryFormat;
+  header.length = (uint32_t)written;
+
+  cache_path(path, sizeof(path), key);
+  snprintf(temporary, sizeof(temporary), "%s.%d.tmp", path, (int)getpid());
+  file = fopen(temporary, "wb");
+  if (!file)
+  {
+    dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "cannot write program cache entry %s\n", temporary);
+    free(binary);
+    return;
+  }
+  ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(binary, 1, written, file) == written;
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(temporary, path) != 0)
+  {
+    unlink(temporary);
+  }
+  free(binary);
+}
+
+/*
+ * @ brief Compile a shader, logging the info log on failure.
+ * @ return The shader, or 0 when it failed to compile.
+ */
+static GLuint compile_shader(GLResourceRegistry* resources, GLenum type, const char* source)
+{
+  GLuint shader = resource_create(resources, GL_RESOURCE_SHADER, type);
+  GLint compiled = GL_FALSE;
+
+  glShaderSource(shader, 1, &source, NULL);
+  glCompileShader(shader);
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (compiled != GL_TRUE)
+  {
+    GLint length = 0;
+    char* log;
+
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    log = length > 0 ? (char*)malloc(length) : NULL;
+    if (log)
+    {
+      glGetShaderInfoLog(shader, length, NULL, log);
+    }
+    dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "%s shader failed to compile: %s\n",
+               type == GL_VERTEX_SHADER ? "vertex" : "fragment", log ? log : "(no info log)");
+    free(log);
+    resource_delete(resources, GL_RESOURCE_SHADER, &shader);
+    return 0;
+  }
+  return shader;
+}
+
+/*
+ * @ brief Check the link status, logging the info log on failure.
+ */
+static int check_link(GLuint program)
+{
+  GLint linked = GL_FALSE;
+  GLint length = 0;
+  char* log;
+
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked == GL_TRUE)
+  {
+    return 1;
+  }
+
+  glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+  log = length > 0 ? (char*)malloc(length) : NULL;
+  if (log)
+  {
+    glGetProgramInfoLog(program, length, NULL, log);
+  }
+  dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "program failed to link: %s\n", log ? log : "(no info log)");
+  free(log);
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int program_set_cache_directory(const char* directory)
+{
+  char* copy = NULL;
+
+  if (directory)
+  {
+    copy = strdup(directory);
+    if (!copy)
+    {
+      return 0;
+    }
+  }
+  free(sCacheDirectory);
+  sCacheDirectory = copy;
+  return 1;
+}
+
+GLuint program_load_binary(GLResourceRegistry* resources, GLenum binaryFormat, const void* binary, size_t length)
+{
+  GLuint program = resource_create(resources, GL_RESOURCE_PROGRAM, 0);
+  GLint linked = GL_FALSE;
+
+  if (!program)
+  {
+    return 0;
+  }
+  glProgramBinary(program, binaryFormat, binary, (GLsizei)length);
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE)
+  {
+    resource_delete(resources, GL_RESOURCE_PROGRAM, &program);
+  }
+  return program;
+}
+
+void* program_get_binary(GLuint program, GLenum* binaryFormat, size_t* length)
+{
+  GLint size = 0;
+  GLsizei written = 0;
+  void* binary;
+
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+  if (size <= 0 || !(binary = malloc(size)))
+  {
+    return NULL;
+  }
+  glGetProgramBinary(program, size, &written, binaryFormat, binary);
+  if (written <= 0)
+  {
+    free(binary);
+    return NULL;
+  }
+  *length = (size_t)written;
+  return binary;
+}
+
+GLuint program_create(GLResourceRegistry* resources, const char* vtxSource, const char* fgmtSource,
+                      const ProgramAttrib* attribs, int attribCount, int glesVersion, GLuint* vtxShader, GLuint* fgmtShader)
+{
+  GLint binaryFormats = 0;
+  uint64_t key = 0;
+  int useCache;
+  GLuint program;
+  int i;
+
+  *vtxShader = 0;
+  *fgmtShader = 0;
+
+  if (glesVersion >= 3)
+  {
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+  }
+  useCache = sCacheDirectory && binaryFormats > 0;
+  if (useCache)
+  {
+    key = program_key(vtxSource, fgmtSource, attribs, attribCount);
+    program = load_cached_program(resources, key);
+    if (program)
+    {
+      return program;
+    }
+  }
+
+  *vtxShader = compile_shader(resources, GL_VERTEX_SHADER, vtxSource);
+  *fgmtShader = compile_shader(resources, GL_FRAGMENT_SHADER, fgmtSource);
+  if (!*vtxShader || !*fgmtShader)
+  {
+    resource_delete(resources, GL_RESOURCE_SHADER, vtxShader);
+    resource_delete(resources, GL_RESOURCE_SHADER, fgmtShader);
+    return 0;
+  }
+
+  program = resource_create(resources, GL_RESOURCE_PROGRAM, 0);
+  glAttachShader(program, *vtxShader);
+  glAttachShader(program, *fgmtShader);
+  for (i = 0; i < attribCount; i++)
+  {
+    glBindAttribLocation(program, attribs[i].index, attribs[i].name);
+  }
+  /* Binaries also restore a lost context, see program_get_binary() */
+  if (binaryFormats > 0)
+  {
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+  glLinkProgram(program);
+
+  if (!check_link(program))
+  {
+    resource_delete(resources, GL_RESOURCE_PROGRAM, &program);
+    resource_delete(resources, GL_RESOURCE_SHADER, vtxShader);
+    resource_delete(resources, GL_RESOURCE_SHADER, fgmtShader);
+    return 0;
+  }
+
+  if (useCache)
+  {
+    store_cached_program(program, key);
+  }
+  return program;
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <GLES3/gl3.h>
+
+#include <dlog.h>
+#include <dali-nativegl-resource_private.h>
+
+#define NATIVEGL_LOG_TAG "DALI_NATIVEGL_LIBRARY"
+
+#define RESOURCE_MIN_CAPACITY 16
+
+static const char* const sKindNames[GL_RESOURCE_KIND_COUNT] = {
+  "program", "shader", "buffer", "texture", "renderbuffer", "framebuffer"
+};
+
+static GLResource* find(GLResourceRegistry* registry, GLResourceKind kind, GLuint name);
+static void delete_object(GLResourceKind kind, GLuint name);
+static void forget(GLResourceRegistry* registry, GLResource* object);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static GLResource* find(GLResourceRegistry* registry, GLResourceKind kind, GLuint name)
+{
+  int i;
+
+  /* Newest first, objects are mostly deleted in reverse order of creation */
+  for (i = registry->count - 1; i >= 0; i--)
+  {
+    if (registry->objects[i].name == name && registry->objects[i].kind == (unsigned int)kind)
+    {
+      return &registry->objects[i];
+    }
+  }
+  return NULL;
+}
+
+static void delete_object(GLResourceKind kind, GLuint name)
+{
+  switch (kind)
+  {
+    case GL_RESOURCE_PROGRAM:
+      glDeleteProgram(name);
+      break;
+    case GL_RESOURCE_SHADER:
+      glDeleteShader(name);
+      break;
+    case GL_RESOURCE_BUFFER:
+      glDeleteBuffers(1, &name);
+      break;
+    case GL_RESOURCE_TEXTURE:
+      glDeleteTextures(1, &name);
+      break;
+    case GL_RESOURCE_RENDERBUFFER:
+      glDeleteRenderbuffers(1, &name);
+      break;
+    case GL_RESOURCE_FRAMEBUFFER:
+      glDeleteFramebuffers(1, &name);
+      break;
+    default:
+      break;
+  }
+}
+
+/*
+ * @ brief Remove an entry, moving the last one into its place.
+ */
+static void forget(GLResourceRegistry* registry, GLResource* object)
+{
+  registry->stats.live[object->kind]--;
+  registry->stats.bytes[object->kind] -= object->bytes;
+  registry->stats.deleted++;
+  *object = registry->objects[--registry->count];
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+GLuint resource_create(GLResourceRegistry* registry, GLResourceKind kind, GLenum type)
+{
+  GLuint name = 0;
+
+  switch (kind)
+  {
+    case GL_RESOURCE_PROGRAM:
+      name = glCreateProgram();
+      break;
+    case GL_RESOURCE_SHADER:
+      name = glCreateShader(type);
+      break;
+    case GL_RESOURCE_BUFFER:
+      glGenBuffers(1, &name);
+      break;
+    case GL_RESOURCE_TEXTURE:
+      glGenTextures(1, &name);
+      break;
+    case GL_RESOURCE_RENDERBUFFER:
+      glGenRenderbuffers(1, &name);
+      break;
+    case GL_RESOURCE_FRAMEBUFFER:
+      glGenFramebuffers(1, &name);
+      break;
+    default:
+      break;
+  }
+  if (!name || !resource_track(registry, kind, name))
+  {
+    return 0;
+  }
+  return name;
+}
+
+int resource_track(GLResourceRegistry* registry, GLResourceKind kind, GLuint name)
+{
+  GLResource* object;
+
+  if (!name)
+  {
+    return 0;
+  }
+  if (registry->count == registry->capacity)
+  {
+    int capacity = registry->capacity ? registry->capacity * 2 : RESOURCE_MIN_CAPACITY;
+    GLResource* objects = (GLResource*)realloc(registry->objects, sizeof(GLResource) * capacity);
+    if (!objects)
+    {
+      dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "cannot register %s %u\n", sKindNames[kind], name);
+      delete_object(kind, name);
+      return 0;
+    }
+    registry->objects = objects;
+    registry->capacity = capacity;
+  }
+
+  object = &registry->objects[registry->count++];
+  object->kind = kind;
+  object->name = name;
+  object->bytes = 0;
+  registry->stats.live[kind]++;
+  registry->stats.created++;
+  return 1;
+}
+
+void resource_set_bytes(GLResourceRegistry* registry, GLResourceKind kind, GLuint name, size_t bytes)
+{
+  GLResource* object = find(registry, kind, name);
+
+  if (object)
+  {
+    registry->stats.bytes[kind] += bytes - object->bytes;
+    object->bytes = bytes;
+  }
+}
+
+void resource_delete(GLResourceRegistry* registry, GLResourceKind kind, GLuint* name)
+{
+  GLResource* object;
+
+  if (!*name)
+  {
+    return;
+  }
+  /* A name the registry does not know belonged to a lost context */
+  object = find(registry, kind, *name);
+  if (object)
+  {
+    delete_object(kind, *name);
+    forget(registry, object);
+  }
+  *name = 0;
+}
+
+int resource_release_all(GLResourceRegistry* registry)
+{
+  int released = registry->count;
+
+  while (registry->count > 0)
+  {
+    GLResource* object = &registry->objects[registry->count - 1];
+    dlog_print(DLOG_WARN, NATIVEGL_LOG_TAG, "releasing leaked %s %u (%zu bytes)\n",
+               sKindNames[object->kind], object->name, object->bytes);
+    delete_object((GLResourceKind)object->kind, object->name);
+    forget(registry, object);
+  }
+  registry->stats.reclaimed += released;
+  return released;
+}
+
+void resource_forget_all(GLResourceRegistry* registry)
+{
+  registry->stats.lost += registry->count;
+  while (registry->count > 0)
+  {
+    forget(registry, &registry->objects[registry->count - 1]);
+  }
+}
+
+void resource_terminate(GLResourceRegistry* registry)
+{
+  free(registry->objects);
+  registry->objects = NULL;
+  registry->count = 0;
+  registry->capacity = 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GLES3/gl3.h>
+
+#include <dali-nativegl-snapshot_private.h>
+#include <dali-nativegl-hash_private.h>
+
+static void remove_part(GLSnapshot* snapshot, GLSnapshotEntry* entry);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+/*
+ * @ brief Close the gap a part leaves, the parts behind it move forward.
+ */
+static void remove_part(GLSnapshot* snapshot, GLSnapshotEntry* entry)
+{
+  const size_t end = entry->offset + entry->size;
+  int i;
+
+  memmove(snapshot->data + entry->offset, snapshot->data + end, snapshot->size - end);
+  snapshot->size -= entry->size;
+  for (i = 0; i < GL_SNAPSHOT_ENTRY_COUNT; i++)
+  {
+    if (snapshot->entries[i].size && snapshot->entries[i].offset >= end)
+    {
+      snapshot->entries[i].offset -= entry->size;
+    }
+  }
+  memset(entry, 0, sizeof(*entry));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void snapshot_begin(GLSnapshot* snapshot, int glesVersion)
+{
+  uint64_t key = hash_driver(HASH_SEED);
+  char version[16];
+
+  snprintf(version, sizeof(version), "%d", glesVersion);
+  key = hash_string(key, version);
+
+  if (key != snapshot->key)
+  {
+    snapshot_clear(snapshot);
+    snapshot->key = key;
+  }
+}
+
+int snapshot_store(GLSnapshot* snapshot, GLSnapshotId id, const void* data, size_t size, unsigned int format)
+{
+  GLSnapshotEntry* entry = &snapshot->entries[id];
+  unsigned char* grown;
+
+  if (entry->size)
+  {
+    remove_part(snapshot, entry);
+  }
+  if (size == 0)
+  {
+    return 1;
+  }
+
+  /* Grown to the exact size: parts are stored once per initialization, the block stays compact */
+  grown = (unsigned char*)realloc(snapshot->data, snapshot->size + size);
+  if (!grown)
+  {
+    return 0;
+  }
+  snapshot->data = grown;
+  memcpy(snapshot->data + snapshot->size, data, size);
+  entry->offset = snapshot->size;
+  entry->size = size;
+  entry->format = format;
+  snapshot->size += size;
+  return 1;
+}
+
+const void* snapshot_find(const GLSnapshot* snapshot, GLSnapshotId id, GLSnapshotEntry* entry)
+{
+  *entry = snapshot->entries[id];
+  return entry->size ? snapshot->data + entry->offset : NULL;
+}
+
+void snapshot_clear(GLSnapshot* snapshot)
+{
+  free(snapshot->data);
+  memset(snapshot, 0, sizeof(*snapshot));
+}
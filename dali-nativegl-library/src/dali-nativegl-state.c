@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <dali-nativegl-state_private.h>
+
+/* Count the change and tell whether it must reach GL */
+#define STATE_CHANGED(state, redundant) \
+  ((redundant) ? ((state)->counters.skipped++, 0) : ((state)->counters.issued++, 1))
+
+void state_invalidate(GLStateCache* state)
+{
+  int i;
+
+  state->validMask = 0;
+  for (i = 0; i < GL_STATE_MAX_ATTRIBS; i++)
+  {
+    state->attribs[i].validMask = 0;
+  }
+}
+
+void state_use_program(GLStateCache* state, GLuint program)
+{
+  if (STATE_CHANGED(state, (state->validMask & STATE_PROGRAM) && state->program == program))
+  {
+    glUseProgram(program);
+    state->program = program;
+    state->validMask |= STATE_PROGRAM;
+  }
+}
+
+void state_bind_buffer(GLStateCache* state, GLenum target, GLuint buffer)
+{
+  unsigned int bit = target == GL_ARRAY_BUFFER ? STATE_ARRAY_BUFFER : STATE_ELEMENT_ARRAY_BUFFER;
+  unsigned int* bound = target == GL_ARRAY_BUFFER ? &state->arrayBuffer : &state->elementArrayBuffer;
+
+  if (STATE_CHANGED(state, (state->validMask & bit) && *bound == buffer))
+  {
+    glBindBuffer(target, buffer);
+    *bound = buffer;
+    state->validMask |= bit;
+  }
+}
+
+void state_viewport(GLStateCache* state, GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  const int viewport[4] = { x, y, width, height };
+
+  if (STATE_CHANGED(state, (state->validMask & STATE_VIEWPORT) && memcmp(state->viewport, viewport, sizeof(viewport)) == 0))
+  {
+    glViewport(x, y, width, height);
+    memcpy(state->viewport, viewport, sizeof(viewport));
+    state->validMask |= STATE_VIEWPORT;
+  }
+}
+
+void state_clear_color(GLStateCache* state, GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+  const float color[4] = { r, g, b, a };
+
+  if (STATE_CHANGED(state, (state->validMask & STATE_CLEAR_COLOR) && memcmp(state->clearColor, color, sizeof(color)) == 0))
+  {
+    glClearColor(r, g, b, a);
+    memcpy(state->clearColor, color, sizeof(color));
+    state->validMask |= STATE_CLEAR_COLOR;
+  }
+}
+
+void state_depth_test(GLStateCache* state, int enable)
+{
+  enable = enable ? 1 : 0;
+  if (STATE_CHANGED(state, (state->validMask & STATE_DEPTH_TEST) && state->depthTest == enable))
+  {
+    if (enable)
+    {
+      glEnable(GL_DEPTH_TEST);
+    }
+    else
+    {
+      glDisable(GL_DEPTH_TEST);
+    }
+    state->depthTest = enable;
+    state->validMask |= STATE_DEPTH_TEST;
+  }
+}
+
+void state_vertex_attrib_pointer(GLStateCache* state, GLuint index, GLuint buffer, GLint size, GLenum type,
+                                 GLboolean normalized, GLsizei stride, const void* offset)
+{
+  GLAttribState* attrib = &state->attribs[index];
+
+  if (STATE_CHANGED(state, (attrib->validMask & STATE_ATTRIB_POINTER) && attrib->buffer == buffer &&
+                           attrib->size == size && attrib->type == type && attrib->normalized == normalized &&
+                           attrib->stride == stride && attrib->offset == offset))
+  {
+    state_bind_buffer(state, GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(index, size, type, normalized, stride, offset);
+    attrib->buffer = buffer;
+    attrib->size = size;
+    attrib->type = type;
+    attrib->normalized = normalized;
+    attrib->stride = stride;
+    attrib->offset = offset;
+    attrib->validMask |= STATE_ATTRIB_POINTER;
+  }
+}
+
+void state_enable_attrib(GLStateCache* state, GLuint index, int enable)
+{
+  GLAttribState* attrib = &state->attribs[index];
+
+  enable = enable ? 1 : 0;
+  if (STATE_CHANGED(state, (attrib->validMask & STATE_ATTRIB_ENABLED) && attrib->enabled == enable))
+  {
+    if (enable)
+    {
+      glEnableVertexAttribArray(index);
+    }
+    else
+    {
+      glDisableVertexAttribArray(index);
+    }
+    attrib->enabled = enable;
+    attrib->validMask |= STATE_ATTRIB_ENABLED;
+  }
+}
+
+void state_attrib_divisor(GLStateCache* state, GLuint index, GLuint divisor)
+{
+  GLAttribState* attrib = &state->attribs[index];
+
+  if (STATE_CHANGED(state, (attrib->validMask & STATE_ATTRIB_DIVISOR) && attrib->divisor == divisor))
+  {
+    glVertexAttribDivisor(index, divisor);
+    attrib->divisor = divisor;
+    attrib->validMask |= STATE_ATTRIB_DIVISOR;
+  }
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <GLES3/gl3.h>
+
+#include <dlog.h>
+#include <dali-nativegl-state_private.h>
+#include <dali-nativegl-stream_private.h>
+#include <dali-nativegl-resource_private.h>
+
+#define NATIVEGL_LOG_TAG "DALI_NATIVEGL_LIBRARY"
+
+/* Smallest region; regions grow to powers of two so a varying size rarely reallocates */
+#define STREAM_MIN_REGION_SIZE 4096
+
+/* Nanoseconds per wait for a fence, repeated until it is signaled */
+#define STREAM_WAIT_TIMEOUT 100000000ull
+
+static void delete_fences(GLStreamBuffer* stream, int contextLost);
+static int reserve(GLStreamBuffer* stream, GLResourceRegistry* resources, int size);
+static void wait_region(GLStreamBuffer* stream, GLStateCache* state);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static void delete_fences(GLStreamBuffer* stream, int contextLost)
+{
+  int i;
+  for (i = 0; i < GL_STREAM_REGIONS; i++)
+  {
+    if (stream->fences[i])
+    {
+      if (!contextLost)
+      {
+        glDeleteSync((GLsync)stream->fences[i]);
+      }
+      stream->fences[i] = NULL;
+    }
+  }
+}
+
+/*
+ * @ brief Grow the regions to hold size bytes, the buffer is bound.
+ * @ return 1 on success, 0 when out of memory.
+ */
+static int reserve(GLStreamBuffer* stream, GLResourceRegistry* resources, int size)
+{
+  int regionSize = stream->regionSize > 0 ? stream->regionSize : STREAM_MIN_REGION_SIZE;
+
+  if (size <= stream->regionSize)
+  {
+    return 1;
+  }
+  while (regionSize < size)
+  {
+    regionSize *= 2;
+  }
+
+  if (stream->mapped)
+  {
+    /* New storage, the fences of the old one need not be waited for */
+    delete_fences(stream, 0);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)regionSize * GL_STREAM_REGIONS, NULL, GL_DYNAMIC_DRAW);
+    resource_set_bytes(resources, GL_RESOURCE_BUFFER, stream->buffer, (size_t)regionSize * GL_STREAM_REGIONS);
+    stream->region = GL_STREAM_REGIONS - 1;
+  }
+  else
+  {
+    void* staging = realloc(stream->staging, regionSize);
+    if (!staging)
+    {
+      return 0;
+    }
+    stream->staging = staging;
+    /* Uploaded by every stream_unmap() */
+    resource_set_bytes(resources, GL_RESOURCE_BUFFER, stream->buffer, regionSize);
+  }
+  stream->regionSize = regionSize;
+  return 1;
+}
+
+/*
+ * @ brief Move to the next region, waiting until the GPU is done with its previous contents.
+ */
+static void wait_region(GLStreamBuffer* stream, GLStateCache* state)
+{
+  GLsync fence;
+
+  stream->region = (stream->region + 1) % GL_STREAM_REGIONS;
+  fence = (GLsync)stream->fences[stream->region];
+  if (!fence)
+  {
+    return;
+  }
+  if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+  {
+    state->counters.streamStalls++;
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_WAIT_TIMEOUT) == GL_TIMEOUT_EXPIRED)
+    {
+    }
+  }
+  glDeleteSync(fence);
+  stream->fences[stream->region] = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void stream_init(GLStreamBuffer* stream, GLResourceRegistry* resources, int mapped)
+{
+  stream->buffer = resource_create(resources, GL_RESOURCE_BUFFER, 0);
+  stream->mapped = mapped;
+  stream->regionSize = 0;
+  stream->region = 0;
+}
+
+void* stream_map(GLStreamBuffer* stream, GLStateCache* state, GLResourceRegistry* resources, int size, int* offset)
+{
+  void* data;
+
+  state_bind_buffer(state, GL_ARRAY_BUFFER, stream->buffer);
+  if (!reserve(stream, resources, size))
+  {
+    return NULL;
+  }
+  stream->size = size;
+
+  if (stream->mapped)
+  {
+    wait_region(stream, state);
+    *offset = stream->region * stream->regionSize;
+    data = glMapBufferRange(GL_ARRAY_BUFFER, *offset, size,
+                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (data)
+    {
+      return data;
+    }
+
+    /* Keep streaming by orphaning, in storage of its own */
+    dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "glMapBufferRange failed (0x%x), orphaning instead\n", glGetError());
+    delete_fences(stream, 0);
+    stream->mapped = 0;
+    stream->regionSize = 0;
+    if (!reserve(stream, resources, size))
+    {
+      return NULL;
+    }
+  }
+
+  *offset = 0;
+  return stream->staging;
+}
+
+int stream_unmap(GLStreamBuffer* stream)
+{
+  if (stream->mapped)
+  {
+    /* GL_FALSE when the storage was lost while mapped, e.g. on a mode change */
+    return glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+  }
+
+  /* Same size every frame so the driver can recycle the orphaned storage */
+  glBufferData(GL_ARRAY_BUFFER, stream->regionSize, NULL, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, stream->size, stream->staging);
+  return 1;
+}
+
+void stream_fence(GLStreamBuffer* stream)
+{
+  if (stream->mapped)
+  {
+    stream->fences[stream->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+}
+
+void stream_terminate(GLStreamBuffer* stream, GLResourceRegistry* resources, int contextLost)
+{
+  delete_fences(stream, contextLost);
+  resource_delete(resources, GL_RESOURCE_BUFFER, &stream->buffer);
+  free(stream->staging);
+  stream->staging = NULL;
+  stream->regionSize = 0;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include <dali-nativegl-timing_private.h>
+
+/* Bound of histogram bucket 0 in milliseconds, each next bucket doubles it */
+#define TIMING_FIRST_BUCKET_MS 0.125f
+
+/* Extension entry points, the same for every context of the driver */
+static PFNGLGENQUERIESEXTPROC          sGenQueries;
+static PFNGLDELETEQUERIESEXTPROC       sDeleteQueries;
+static PFNGLBEGINQUERYEXTPROC          sBeginQuery;
+static PFNGLENDQUERYEXTPROC            sEndQuery;
+static PFNGLGETQUERYOBJECTUIVEXTPROC   sGetQueryObjectuiv;
+static PFNGLGETQUERYOBJECTUI64VEXTPROC sGetQueryObjectui64v;
+
+static double timing_now_ms(void);
+static void add_sample(GLFrameTiming* timing, GLTimingPass pass, float ms);
+static int gpu_timer_supported(void);
+static int compare_float(const void* a, const void* b);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static double timing_now_ms(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+static void add_sample(GLFrameTiming* timing, GLTimingPass pass, float ms)
+{
+  timing->samples[pass][timing->sampleCount[pass] % GL_TIMING_WINDOW] = ms;
+  timing->sampleCount[pass]++;
+}
+
+static int gpu_timer_supported(void)
+{
+  const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+
+  if (!extensions || !strstr(extensions, "GL_EXT_disjoint_timer_query"))
+  {
+    return 0;
+  }
+  sGenQueries = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+  sDeleteQueries = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+  sBeginQuery = (PFNGLBEGINQUERYEXTPROC)eglGetProcAddress("glBeginQueryEXT");
+  sEndQuery = (PFNGLENDQUERYEXTPROC)eglGetProcAddress("glEndQueryEXT");
+  sGetQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+  sGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+  return sGenQueries && sDeleteQueries && sBeginQuery && sEndQuery && sGetQueryObjectuiv && sGetQueryObjectui64v;
+}
+
+static int compare_float(const void* a, const void* b)
+{
+  float x = *(const float*)a;
+  float y = *(const float*)b;
+  return (x > y) - (x < y);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double timing_cpu_begin(const GLFrameTiming* timing)
+{
+  return timing->enabled ? timing_now_ms() : 0.0;
+}
+
+void timing_cpu_end(GLFrameTiming* timing, GLTimingPass pass, double start)
+{
+  if (timing->enabled && start > 0.0)
+  {
+    add_sample(timing, pass, (float)(timing_now_ms() - start));
+  }
+}
+
+int timing_gpu_begin(GLFrameTiming* timing)
+{
+  GLint disjoint = 0;
+
+  if (!timing->enabled || timing->gpuSupported < 0)
+  {
+    return 0;
+  }
+  if (timing->gpuSupported == 0)
+  {
+    timing->gpuSupported = gpu_timer_supported() ? 1 : -1;
+    if (timing->gpuSupported < 0)
+    {
+      return 0;
+    }
+    sGenQueries(GL_TIMING_QUERIES, timing->queries);
+    timing->queryHead = 0;
+    timing->queryTail = 0;
+  }
+
+  /* A disjoint operation (e.g. a frequency change) makes every pending result meaningless */
+  glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+  if (disjoint)
+  {
+    timing->queryTail = timing->queryHead;
+  }
+
+  while (timing->queryTail != timing->queryHead)
+  {
+    GLuint query = timing->queries[timing->queryTail % GL_TIMING_QUERIES];
+    GLuint available = 0;
+    GLuint64 elapsed = 0;
+
+    sGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+    if (!available)
+    {
+      break;
+    }
+    sGetQueryObjectui64v(query, GL_QUERY_RESULT_EXT, &elapsed);
+    add_sample(timing, GL_TIMING_GPU_RENDER, (float)(elapsed / 1000000.0));
+    timing->queryTail++;
+  }
+
+  /* Never wait for the GPU, leave this frame out when every query is still in flight */
+  if (timing->queryHead - timing->queryTail >= GL_TIMING_QUERIES)
+  {
+    return 0;
+  }
+  sBeginQuery(GL_TIME_ELAPSED_EXT, timing->queries[timing->queryHead % GL_TIMING_QUERIES]);
+  timing->queryHead++;
+  return 1;
+}
+
+void timing_gpu_end(GLFrameTiming* timing, int started)
+{
+  if (started)
+  {
+    sEndQuery(GL_TIME_ELAPSED_EXT);
+  }
+}
+
+void timing_terminate(GLFrameTiming* timing, int contextLost)
+{
+  if (timing->gpuSupported > 0 && !contextLost)
+  {
+    sDeleteQueries(GL_TIMING_QUERIES, timing->queries);
+  }
+  memset(timing->queries, 0, sizeof(timing->queries));
+  timing->gpuSupported = 0;
+  timing->queryHead = 0;
+  timing->queryTail = 0;
+}
+
+int timing_stats(const GLFrameTiming* timing, GLTimingPass pass, GLTimingStats* stats)
+{
+  float sorted[GL_TIMING_WINDOW];
+  unsigned int count = timing->sampleCount[pass] < GL_TIMING_WINDOW ? timing->sampleCount[pass] : GL_TIMING_WINDOW;
+  double total = 0.0;
+  unsigned int i;
+
+  memset(stats, 0, sizeof(*stats));
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  memcpy(sorted, timing->samples[pass], sizeof(float) * count);
+  qsort(sorted, count, sizeof(float), compare_float);
+  for (i = 0; i < count; i++)
+  {
+    float bound = TIMING_FIRST_BUCKET_MS;
+    int bucket = 0;
+
+    while (bucket < GL_TIMING_BUCKETS - 1 && sorted[i] >= bound)
+    {
+      bound *= 2.0f;
+      bucket++;
+    }
+    stats->histogram[bucket]++;
+    total += sorted[i];
+  }
+
+  /* Nearest rank percentiles */
+  stats->samples = count;
+  stats->mean = (float)(total / count);
+  stats->p50 = sorted[(count * 50 + 99) / 100 - 1];
+  stats->p95 = sorted[(count * 95 + 99) / 100 - 1];
+  stats->p99 = sorted[(count * 99 + 99) / 100 - 1];
+  stats->max = sorted[count - 1];
+  return 1;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <dali-nativegl-trace_private.h>
+
+#ifdef NATIVEGL_TRACE
+
+/* Must be a power of two */
+#define TRACE_BUFFER_SIZE 16384
+#define TRACE_BUFFER_MASK (TRACE_BUFFER_SIZE - 1)
+
+typedef struct {
+    unsigned int sequence;   /* Index + 1 of the event in the slot, 0 while it is written */
+    char         phase;      /* Chrome trace phase: 'X' span, 'C' counter, 'i' instant */
+    int          tid;
+    const char*  name;
+    double       timestamp;  /* Microseconds */
+    double       value;      /* Duration of a span, value of a counter */
+} TraceEvent;
+
+/*
+ * Writers from any thread claim an index with one atomic add and publish the slot with a
+ * release store of its sequence. The dump copies a slot and keeps it only when the sequence
+ * was the expected one before and after the copy, so overwritten slots are skipped.
+ */
+static TraceEvent sEvents[TRACE_BUFFER_SIZE];
+static unsigned int sHead;
+static unsigned int sStart;
+static __thread int sTid;
+
+static double trace_time_us(void);
+static void trace_record(char phase, const char* name, double timestamp, double value);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+static double trace_time_us(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+static void trace_record(char phase, const char* name, double timestamp, double value)
+{
+  unsigned int index = __atomic_fetch_add(&sHead, 1, __ATOMIC_RELAXED);
+  TraceEvent* event = &sEvents[index & TRACE_BUFFER_MASK];
+
+  if (!sTid)
+  {
+    sTid = (int)syscall(SYS_gettid);
+  }
+
+  __atomic_store_n(&event->sequence, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  event->phase = phase;
+  event->tid = sTid;
+  event->name = name;
+  event->timestamp = timestamp;
+  event->value = value;
+  __atomic_store_n(&event->sequence, index + 1, __ATOMIC_RELEASE);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TraceSpan trace_span_begin(const char* name)
+{
+  TraceSpan span;
+  span.name = name;
+  span.start = trace_time_us();
+  return span;
+}
+
+void trace_span_end(TraceSpan* span)
+{
+  trace_record('X', span->name, span->start, trace_time_us() - span->start);
+}
+
+void trace_counter(const char* name, double value)
+{
+  trace_record('C', name, trace_time_us(), value);
+}
+
+void trace_instant(const char* name)
+{
+  trace_record('i', name, trace_time_us(), 0.0);
+}
+
+int trace_dump(const char* path)
+{
+  unsigned int head = __atomic_load_n(&sHead, __ATOMIC_ACQUIRE);
+  unsigned int start = __atomic_load_n(&sStart, __ATOMIC_RELAXED);
+  unsigned int index;
+  int pid = (int)getpid();
+  int first = 1;
+  FILE* file;
+
+  file = fopen(path, "w");
+  if (!file)
+  {
+    return 0;
+  }
+
+  if (head - start > TRACE_BUFFER_SIZE)
+  {
+    start = head - TRACE_BUFFER_SIZE;
+  }
+
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  for (index = start; index != head; index++)
+  {
+    TraceEvent* slot = &sEvents[index & TRACE_BUFFER_MASK];
+    TraceEvent event;
+
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != index + 1)
+    {
+      continue;
+    }
+    event = *slot;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) != index + 1)
+    {
+      continue;
+    }
+
+    fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"nativegl\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f",
+            first ? "" : ",", event.name, event.phase, pid, event.tid, event.timestamp);
+    if (event.phase == 'X')
+    {
+      fprintf(file, ",\"dur\":%.3f}", event.value);
+    }
+    else if (event.phase == 'C')
+    {
+      fprintf(file, ",\"args\":{\"value\":%g}}", event.value);
+    }
+    else
+    {
+      fprintf(file, ",\"s\":\"t\"}");
+    }
+    first = 0;
+  }
+  fprintf(file, "\n]}\n");
+
+  return fclose(file) == 0;
+}
+
+void trace_reset(void)
+{
+  __atomic_store_n(&sStart, __atomic_load_n(&sHead, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+}
+
+#else
+
+int trace_dump(const char* path)
+{
+  (void)path;
+  return 0;
+}
+
+void trace_reset(void)
+{
+}
+
+#endif
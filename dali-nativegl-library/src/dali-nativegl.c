@@ -25,14 +25,32 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <math.h>
-#include <GLES2/gl2.h>
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
 
 
 #include <dlog.h>
 #ifdef LOG_TAG
 #undef LOG_TAG
 #endif
-#include <dali-nativegl-library.h>
+#include <dali-nativegl-library_private.h>
+#include <dali-nativegl-matrix_private.h>
+#include <dali-nativegl-camera_private.h>
+#include <dali-nativegl-mesh_private.h>
+#include <dali-nativegl-state_private.h>
+#include <dali-nativegl-program_private.h>
+#include <dali-nativegl-input_private.h>
+#include <dali-nativegl-trace_private.h>
+#include <dali-nativegl-timing_private.h>
+#include <dali-nativegl-cull_private.h>
+#include <dali-nativegl-jobs_private.h>
+#include <dali-nativegl-stream_private.h>
+#include <dali-nativegl-capture_private.h>
+#include <dali-nativegl-resource_private.h>
+#include <dali-nativegl-snapshot_private.h>
+
+#define NATIVEGL_LOG_TAG "DALI_NATIVEGL_LIBRARY"
 
 #ifndef EXPORT_API
 #define EXPORT_API __attribute__ ((visibility("default")))
@@ -108,58 +126,259 @@ static const char fragment_shader[] =
     "   gl_FragColor = vec4 ( outColor, 1.0 );\n"
     "}\n";
 
+/* GLES3 instanced field: one draw call, the MVP comes from a per-instance attribute */
+static const char instanced_vertex_shader[] =
+    "#version 300 es\n"
+    "in vec4 vPosition;\n"
+    "in vec3 inColor;\n"
+    "in mat4 instanceMvp;\n"
+    "out vec3 outColor;\n"
+    "void main()\n"
+    "{\n"
+    "   outColor = inColor;\n"
+    "   gl_Position = instanceMvp * vPosition;\n"
+    "}\n";
+
+static const char instanced_fragment_shader[] =
+    "#version 300 es\n"
+    "precision mediump float;\n"
+    "in vec3 outColor;\n"
+    "out vec4 fragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   fragColor = vec4 ( outColor, 1.0 );\n"
+    "}\n";
+
+/* GLES2 batched field: BATCH_SIZE cube copies in one buffer, each picks its MVP from a uniform array.
+   24 matrices keep the shader within the 128 vertex uniform vectors every GLES2 driver provides. */
+#define BATCH_SIZE 24
+#define CUBE_VERTEX_COUNT 36
+
+static const char batched_vertex_shader[] =
+    "attribute vec4 vPosition;\n"
+    "attribute vec3 inColor;\n"
+    "attribute float batchIndex;\n"
+    "uniform mat4 batchMvp[24];\n"
+    "varying vec3 outColor;\n"
+    "void main()\n"
+    "{\n"
+    "   outColor = inColor;\n"
+    "   gl_Position = batchMvp[int(batchIndex)] * vPosition;\n"
+    "}\n";
+
+/* Drag prediction: weight of a new velocity sample, longest extrapolation, and the sample age
+   after which the finger is considered resting */
+#define PREDICTION_SMOOTHING 0.5f
+#define PREDICTION_MAX_MS 50.0f
+#define PREDICTION_REST_MS 100.0
+
+/* Parallel scene update: subtrees culled per thread (more than one balances uneven subtrees),
+   the fields worth splitting, and instance matrices per job range */
+#define CULL_JOB_PARTS_PER_THREAD 4
+#define CULL_JOB_MAX_PARTS 256
+#define CULL_JOB_MIN_OBJECTS 4096
+#define MVP_JOB_GRAIN 1024
+
+/* Attribute locations shared by all programs, the instance matrix uses 2..5 */
+#define ATTRIB_POSITION 0
+#define ATTRIB_COLOR 1
+#define ATTRIB_INSTANCE 2
+
+typedef struct {
+    GLData*      glData;
+    const float* clip;
+    int          roots[CULL_JOB_MAX_PARTS];
+    int          firsts[CULL_JOB_MAX_PARTS];
+    int          counts[CULL_JOB_MAX_PARTS];
+} CullJob;
+
+typedef struct {
+    GLData*      glData;
+    const float* view;
+    const int*   visible;    /* NULL when drawing all instances */
+    float*       mvps;       /* 16 floats per instance to draw */
+    float        base[16];
+} MvpJob;
+
 static GLData mGLData;
 
-static void generateAndBindBuffer(unsigned int *vbo);
-static void init_matrix(float matrix[16]);
+static int load_scene_mesh(GLData* glData, Mesh* mesh);
+static int generateAndBindBuffer(GLData* glData);
+static GLuint create_static_buffer(GLData* glData, GLenum target, const void* data, size_t size);
+static void bind_mesh_attributes(GLData* glData, GLuint buffer, int stride);
 static void init_shaders(GLData* glData);
-static void multiply_matrix(float matrix[16], const float matrix0[16], const float matrix1[16]);
-static void rotate_xyz(float matrix[16], const float anglex, const float angley, const float anglez);
-static int view_set_ortho(float result[16], const float left, const float right, const float bottom, const float top, const float near, const float far);
+static unsigned int create_program(GLData* glData, GLSnapshotId id, const char* vtxSource, const char* fgmtSource, const char* instanceAttrib, GLuint* vtxShader, GLuint* fgmtShader);
+static void layout_instances(GLData* glData);
+static int upload_batch(GLData* glData);
+static int init_instancing(GLData* glData);
+static void instance_box(const GLData* glData, const float* offset, float box[6]);
+static void cull_job(void* data, int begin, int end);
+static int cull_instances(GLData* glData, const float clip[16], const int** visible);
+static void mvp_job(void* data, int begin, int end);
+static void update_instance_mvps(GLData* glData, const float view[16], const int* visible, int count,
+                                 float* mvps);
+static void render_instanced(GLData* glData);
+static void render_single(GLData* glData);
+static void turn_cube(float orientation[4], float dx, float dy);
+static void arcball_point(const GLData* glData, FloatPoint position, float point[3]);
+static void arcball_turn(const GLData* glData, float orientation[4], FloatPoint from, FloatPoint to);
+static void update_model(GLData* glData, const float displayOrientation[4]);
+static void apply_input(GLData* glData);
+static void mark_dirty(GLData* glData);
+static void release_gl_objects(GLData* glData, int contextLost);
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Internal functions
 /*
- * brief Generate and bind vertex buffer.
+ * @ brief Map the mesh file of the instance, or build the cube when there is none or it cannot be drawn.
+ */
+static int load_scene_mesh(GLData* glData, Mesh* mesh)
+{
+  if (glData->meshPath)
+  {
+    if (mesh_load_file(mesh, glData->meshPath))
+    {
+      const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+      if (mesh->format == MESH_FORMAT_HALF_FLOAT && glData->vertexFormat != MESH_FORMAT_HALF_FLOAT)
+      {
+        dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "%s: half float vertices are not supported\n", glData->meshPath);
+      }
+      else if (mesh->indexSize == 4 && glData->glesVersion < 3 &&
+               !(extensions && strstr(extensions, "GL_OES_element_index_uint")))
+      {
+        dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "%s: 32 bit indices are not supported\n", glData->meshPath);
+      }
+      else
+      {
+        return 1;
+      }
+      mesh_destroy(mesh);
+    }
+    else
+    {
+      dlog_print(DLOG_ERROR, NATIVEGL_LOG_TAG, "%s: not a valid mesh file\n", glData->meshPath);
+    }
+  }
+  return mesh_create_indexed(mesh, cube_vertices, CUBE_VERTEX_COUNT, (MeshFormat)glData->vertexFormat);
+}
+
+/*
+ * brief Generate and bind vertex and index buffers of the scene mesh.
+ * details The cube's 36 expanded vertices share 24 unique ones; sizes come from the packed mesh.
+ *         A mesh file is uploaded straight from its mapping, a restored scene maps it again
+ *         rather than keeping a copy.
  */
-static void generateAndBindBuffer(unsigned int *vbo)
+static int generateAndBindBuffer(GLData* glData)
 {
-  /* Generate buffer object names */
-  glGenBuffers(1, vbo);
+  Mesh mesh;
+  TRACE_SCOPE("upload_mesh");
+
+  if (!load_scene_mesh(glData, &mesh))
+  {
+    return 0;
+  }
+
+  glData->vbo = create_static_buffer(glData, GL_ARRAY_BUFFER, mesh.vertices, mesh_vertex_bytes(&mesh));
+  glData->ibo = create_static_buffer(glData, GL_ELEMENT_ARRAY_BUFFER, mesh.indices, mesh_index_bytes(&mesh));
+
+  glData->indexCount = mesh.indexCount;
+  glData->indexType = mesh_index_type(mesh.indexSize);
+  glData->vertexFormat = mesh.format;
 
-  /* Bind a named buffer object */
-  glBindBuffer(GL_ARRAY_BUFFER, *vbo);
+  /* The cubes of the field rotate around their origin, cull them by the enclosing sphere */
+  {
+    float box[6];
+    float extent = 0.0f;
+    int axis;
+
+    mesh_bounds(&mesh, box);
+    for (axis = 0; axis < 3; axis++)
+    {
+      float side = fabsf(box[axis]) > fabsf(box[axis + 3]) ? fabsf(box[axis]) : fabsf(box[axis + 3]);
+      extent += side * side;
+    }
+    glData->meshRadius = sqrtf(extent);
+    cull_tree_destroy(glData->cullTree);
+    glData->cullTree = NULL;
+  }
+  mesh_destroy(&mesh);
+  return 1;
+}
+
+/*
+ * @ brief Create a buffer bound to target holding size bytes of data, drawn many times.
+ */
+static GLuint create_static_buffer(GLData* glData, GLenum target, const void* data, size_t size)
+{
+  GLuint buffer = resource_create(&glData->resources, GL_RESOURCE_BUFFER, 0);
 
-  /* Creates and initializes a buffer object's data store */
-  glBufferData(GL_ARRAY_BUFFER, 3 * 72 * 4, cube_vertices, GL_STATIC_DRAW);
+  state_bind_buffer(&glData->state, target, buffer);
+  glBufferData(target, size, data, GL_STATIC_DRAW);
+  resource_set_bytes(&glData->resources, GL_RESOURCE_BUFFER, buffer, size);
+  return buffer;
 }
 
 /*
- * @ brief Initialize matrix
- * @ param[in]
- *     1 0 0 0
- *     0 1 0 0
- *     0 0 1 0
- *     0 0 0 1
+ * @ brief Point the position and color attributes at packed mesh vertices in buffer.
+ * @ param[in] stride Vertex stride, larger than the format's when vertices carry extra data.
+ */
+static void bind_mesh_attributes(GLData* glData, GLuint buffer, int stride)
+{
+  const MeshFormat format = (MeshFormat)glData->vertexFormat;
+
+  if (format == MESH_FORMAT_HALF_FLOAT)
+  {
+    state_vertex_attrib_pointer(&glData->state, ATTRIB_POSITION, buffer, 3,
+                                glData->glesVersion >= 3 ? GL_HALF_FLOAT : GL_HALF_FLOAT_OES, GL_FALSE, stride, 0);
+  }
+  else
+  {
+    state_vertex_attrib_pointer(&glData->state, ATTRIB_POSITION, buffer, 3, GL_FLOAT, GL_FALSE, stride, 0);
+  }
+  state_vertex_attrib_pointer(&glData->state, ATTRIB_COLOR, buffer, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                              (void*)(size_t)mesh_format_color_offset(format));
+  state_enable_attrib(&glData->state, ATTRIB_POSITION, 1);
+  state_enable_attrib(&glData->state, ATTRIB_COLOR, 1);
+}
+
+/**
+ * @ brief Compile and link a program with the shared attribute locations.
+ * @ param[in] id             Snapshot part of the program's binary, loaded instead of compiling when kept.
+ * @ param[in] instanceAttrib Name of the per-instance attribute, or NULL.
+ * @ return The program, or 0 when it failed to build (the error is logged).
  */
-static  void init_matrix(float matrix[16])
-{
-  matrix[0] = 1.0f;
-  matrix[1] = 0.0f;
-  matrix[2] = 0.0f;
-  matrix[3] = 0.0f;
-  matrix[4] = 0.0f;
-  matrix[5] = 1.0f;
-  matrix[6] = 0.0f;
-  matrix[7] = 0.0f;
-  matrix[8] = 0.0f;
-  matrix[9] = 0.0f;
-  matrix[10] = 1.0f;
-  matrix[11] = 0.0f;
-  matrix[12] = 0.0f;
-  matrix[13] = 0.0f;
-  matrix[14] = 0.0f;
-  matrix[15] = 1.0f;
+static unsigned int create_program(GLData* glData, GLSnapshotId id, const char* vtxSource, const char* fgmtSource, const char* instanceAttrib, GLuint* vtxShader, GLuint* fgmtShader)
+{
+  const ProgramAttrib attribs[] = {
+    { ATTRIB_POSITION, "vPosition" },
+    { ATTRIB_COLOR, "inColor" },
+    { ATTRIB_INSTANCE, instanceAttrib }
+  };
+  GLSnapshotEntry entry;
+  const void* binary = snapshot_find(&glData->snapshot, id, &entry);
+  GLuint program = 0;
+  GLenum binaryFormat;
+  size_t length;
+  void* built;
+
+  if (binary)
+  {
+    *vtxShader = 0;
+    *fgmtShader = 0;
+    program = program_load_binary(&glData->resources, entry.format, binary, entry.size);
+    if (program)
+    {
+      return program;
+    }
+  }
+
+  program = program_create(&glData->resources, vtxSource, fgmtSource, attribs, instanceAttrib ? 3 : 2, glData->glesVersion, vtxShader, fgmtShader);
+  if (program && glData->glesVersion >= 3 && (built = program_get_binary(program, &binaryFormat, &length)) != NULL)
+  {
+    snapshot_store(&glData->snapshot, id, built, length, binaryFormat);
+    free(built);
+  }
+  return program;
 }
 
 /**
@@ -167,248 +386,1345 @@ static  void init_matrix(float matrix[16])
  */
 static  void init_shaders(GLData* glData)
 {
-  const char *p = vertex_shader;
-  glData->vtx_shader = glCreateShader(GL_VERTEX_SHADER);
-  glShaderSource(glData->vtx_shader, 1, &p, NULL);
-  glCompileShader(glData->vtx_shader);
+  TRACE_SCOPE("init_shaders");
+  glData->program = create_program(glData, GL_SNAPSHOT_PROGRAM, vertex_shader, fragment_shader, NULL, &glData->vtx_shader, &glData->fgmt_shader);
+  glData->mvpLocation = glGetUniformLocation(glData->program, "mvpMatrix");
+  glData->mvpUploaded = 0;
+  state_use_program(&glData->state, glData->program);
+}
 
-  p = fragment_shader;
-  glData->fgmt_shader = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(glData->fgmt_shader, 1, &p, NULL);
-  glCompileShader(glData->fgmt_shader);
+/*
+ * @ brief Place the instances on a cubic grid filling [-0.9, 0.9] in every axis.
+ */
+static void layout_instances(GLData* glData)
+{
+  int side = 1;
+  int i;
+  float spacing;
 
-  glData->program = glCreateProgram();
-  glAttachShader(glData->program, glData->vtx_shader);
-  glAttachShader(glData->program, glData->fgmt_shader);
-  glBindAttribLocation(glData->program, 0, "vPosition");
-  glBindAttribLocation(glData->program, 1, "inColor");
+  while (side * side * side < glData->instanceCount)
+  {
+    side++;
+  }
+  spacing = 1.8f / side;
 
-  glLinkProgram(glData->program);
-  glUseProgram(glData->program);
+  for (i = 0; i < glData->instanceCount; i++)
+  {
+    float* offset = glData->instanceOffsets + i * 4;
+    offset[0] = -0.9f + spacing * (0.5f + i % side);
+    offset[1] = -0.9f + spacing * (0.5f + (i / side) % side);
+    offset[2] = -0.9f + spacing * (0.5f + i / (side * side));
+    /* A unit cube spans sqrt(3) when rotated, keep neighbours apart */
+    offset[3] = spacing * 0.5f;
+  }
 }
 
 /*
- * @ brief Multiply 4x4 matrix
- * @ param[in] matrix
- * @ param[in] matrix0
- * @ param[in] matrix1
- * @ matrix = matrix0 x matrix1
+ * @ brief GLES2 field geometry: the mesh replicated up to BATCH_SIZE times, each vertex tagged
+ *         with its copy index. A restored scene builds it again from the mesh.
+ * @ return 1 on success, 0 when the mesh cannot be loaded or out of memory.
  */
-static void multiply_matrix(float matrix[16], const float matrix0[16], const float matrix1[16])
+static int upload_batch(GLData* glData)
 {
-  int i;
-  int row;
-  int column;
-  float temp[16];
+  Mesh mesh;
+  unsigned char* batch;
+  unsigned char* indices;
+  size_t vertexBytes, indexBytes;
+  int stride, batchStride, copies, indexSize, copy, vertex;
+
+  if (!load_scene_mesh(glData, &mesh))
+  {
+    return 0;
+  }
+  stride = mesh_format_stride(mesh.format);
+  batchStride = stride + 4;
+  /* Stay within 16 bit indices unless a single copy already needs 32 bits */
+  copies = mesh.vertexCount > 0 ? 0x10000 / mesh.vertexCount : BATCH_SIZE;
+  copies = copies > BATCH_SIZE ? BATCH_SIZE : (copies < 1 ? 1 : copies);
+  indexSize = copies * mesh.vertexCount <= 0x10000 ? 2 : 4;
+  batch = (unsigned char*)malloc((size_t)batchStride * mesh.vertexCount * copies +
+                                 (size_t)indexSize * mesh.indexCount * copies);
+  if (!batch)
+  {
+    mesh_destroy(&mesh);
+    return 0;
+  }
+  indices = batch + (size_t)batchStride * mesh.vertexCount * copies;
 
-  for (column = 0; column < 4; column++)
+  for (copy = 0; copy < copies; copy++)
   {
-    for (row = 0; row < 4; row++)
+    for (vertex = 0; vertex < mesh.vertexCount; vertex++)
     {
-      temp[column * 4 + row] = 0.0f;
-      for (i = 0; i < 4; i++)
+      unsigned char* dst = batch + ((size_t)copy * mesh.vertexCount + vertex) * batchStride;
+      memcpy(dst, mesh.vertices + (size_t)vertex * stride, stride);
+      dst[stride] = (unsigned char)copy;
+      dst[stride + 1] = dst[stride + 2] = dst[stride + 3] = 0;
+    }
+    for (vertex = 0; vertex < mesh.indexCount; vertex++)
+    {
+      unsigned int index;
+      size_t position = (size_t)copy * mesh.indexCount + vertex;
+      if (mesh.indexSize == 1)
+      {
+        index = ((const unsigned char*)mesh.indices)[vertex];
+      }
+      else if (mesh.indexSize == 2)
+      {
+        index = ((const unsigned short*)mesh.indices)[vertex];
+      }
+      else
+      {
+        index = ((const unsigned int*)mesh.indices)[vertex];
+      }
+      index += copy * mesh.vertexCount;
+      if (indexSize == 2)
       {
-        temp[column * 4 + row] += matrix0[i * 4 + row] * matrix1[column * 4 + i];
+        ((unsigned short*)indices)[position] = (unsigned short)index;
+      }
+      else
+      {
+        ((unsigned int*)indices)[position] = index;
       }
     }
   }
 
-  for (i = 0; i < 16; i++)
-  {
-    matrix[i] = temp[i];
-  }
+
+  vertexBytes = (size_t)batchStride * mesh.vertexCount * copies;
+  indexBytes = (size_t)indexSize * mesh.indexCount * copies;
+  glData->instanceVbo = create_static_buffer(glData, GL_ARRAY_BUFFER, batch, vertexBytes);
+  glData->instanceIbo = create_static_buffer(glData, GL_ELEMENT_ARRAY_BUFFER, indices, indexBytes);
+  glData->instanceBatchSize = copies;
+  glData->instanceIndexType = mesh_index_type(indexSize);
+  free(batch);
+  mesh_destroy(&mesh);
+  return 1;
 }
 
 /*
- * @ brief Rotate a matrix
- * @ param[in] matrix The matrix rotated angle.
- * @ param[in] anglex Rotate x-angle.
- * @ param[in] angley Rotate y-angle.
- * @ param[in] anglez Rotate z-angle.
+ * @ brief Create the program and buffer of the cube field on first use.
  */
-static void rotate_xyz(float matrix[16], const float anglex, const float angley, const float anglez)
+static int init_instancing(GLData* glData)
 {
-  const float pi = 3.141592f;
-  float temp[16];
-  float rz = 2.0f * pi * anglez / 360.0f;
-  float rx = 2.0f * pi * anglex / 360.0f;
-  float ry = 2.0f * pi * angley / 360.0f;
+  /* A failure is logged once, do not retry every frame */
+  if (glData->instancingFailed)
+  {
+    return 0;
+  }
+  if (glData->instanceProgram)
+  {
+    return 1;
+  }
+  glData->instancingFailed = 1;
 
-  float sy = sinf(ry);
-  float cy = cosf(ry);
-  float sx = sinf(rx);
-  float cx = cosf(rx);
-  float sz = sinf(rz);
-  float cz = cosf(rz);
-  init_matrix(temp);
+  if (glData->glesVersion >= 3)
+  {
+    glData->instanceProgram = create_program(glData, GL_SNAPSHOT_INSTANCE_PROGRAM, instanced_vertex_shader, instanced_fragment_shader, "instanceMvp",
+                                             &glData->instanceVtxShader, &glData->instanceFgmtShader);
+    if (!glData->instanceProgram)
+    {
+      return 0;
+    }
+    stream_init(&glData->instanceStream, &glData->resources, 1);
+  }
+  else
+  {
+    glData->instanceProgram = create_program(glData, GL_SNAPSHOT_INSTANCE_PROGRAM, batched_vertex_shader, fragment_shader, "batchIndex",
+                                             &glData->instanceVtxShader, &glData->instanceFgmtShader);
+    if (!glData->instanceProgram)
+    {
+      return 0;
+    }
+    glData->instanceMvpLocation = glGetUniformLocation(glData->instanceProgram, "batchMvp");
+    if (!upload_batch(glData))
+    {
+      return 0;
+    }
+  }
+  glData->instancingFailed = 0;
+  return 1;
+}
 
-  temp[0] = cy * cz - sx * sy * sz;
-  temp[1] = cz * sx * sy + cy * sz;
-  temp[2] = -cx * sy;
+/*
+ * @ brief Bounds of an instance: the mesh's bounding sphere placed by offset (x, y, z, scale).
+ */
+static void instance_box(const GLData* glData, const float* offset, float box[6])
+{
+  const float radius = glData->meshRadius * offset[3];
+  int axis;
 
-  temp[4] = -cx * sz;
-  temp[5] = cx * cz;
-  temp[6] = sx;
+  for (axis = 0; axis < 3; axis++)
+  {
+    box[axis] = offset[axis] - radius;
+    box[axis + 3] = offset[axis] + radius;
+  }
+}
 
-  temp[8] = cz * sy + cy * sx * sz;
-  temp[9] = -cy * cz * sx + sy * sz;
-  temp[10] = cx * cy;
+/*
+ * @ brief Cull the subtrees of a split tree, each into its own part of visibleInstances.
+ */
+static void cull_job(void* data, int begin, int end)
+{
+  CullJob* job = (CullJob*)data;
+  int i;
 
-  multiply_matrix(matrix, matrix, temp);
+  TRACE_SCOPE("cull_job");
+  for (i = begin; i < end; i++)
+  {
+    job->counts[i] = cull_tree_query_subtree(job->glData->cullTree, job->roots[i], job->clip,
+                                             job->glData->visibleInstances + job->firsts[i]);
+  }
 }
 
 /*
- * @ brief Creates a matrix for an orthographic parallel viewing volume.
- * @ param[in] result
- * @ param[in] left, right Specify the coordinates for the left and right vertical clipping planes.
- * @ param[in] bottom, top Specify the coordinates for the bottom and top horizontal clipping planes.
- * @ param[in] near, far   Specify the distances to the nearer and farther depth clipping planes.
- *			   These values are negative if the plane is the plane is to be behind the viewer.
+ * @ brief Find the instances inside the view volume of clip.
+ * @ param[out] visible Indices of the instances to draw, NULL to draw all of them in order.
+ * @ return The number of instances to draw.
  */
-static int view_set_ortho(float result[16], const float left, const float right,
-               const float bottom, const float top, const float near, const float far)
+static int cull_instances(GLData* glData, const float clip[16], const int** visible)
 {
-  if ((right - left) == 0.0f || (top - bottom) == 0.0f || (far - near) == 0.0f)
+  CullJob job;
+  int count, workers, parts, i;
+
+  *visible = NULL;
+  if (glData->cullingDisabled)
   {
-    return 0;
+    glData->state.counters.visibleObjects += glData->instanceCount;
+    return glData->instanceCount;
   }
 
-  result[0] = 2.0f / (right - left);
-  result[1] = 0.0f;
-  result[2] = 0.0f;
-  result[3] = 0.0f;
-  result[4] = 0.0f;
-  result[5] = 2.0f / (top - bottom);
-  result[6] = 0.0f;
-  result[7] = 0.0f;
-  result[8] = 0.0f;
-  result[9] = 0.0f;
-  result[10] = -2.0f / (far - near);
-  result[11] = 0.0f;
-  result[12] = -(right + left) / (right - left);
-  result[13] = -(top + bottom) / (top - bottom);
-  result[14] = -(far + near) / (far - near);
-  result[15] = 1.0f;
+  if (!glData->cullTree)
+  {
+    float* boxes = (float*)malloc(sizeof(float) * 6 * glData->instanceCount);
+    if (boxes)
+    {
+      for (i = 0; i < glData->instanceCount; i++)
+      {
+        instance_box(glData, glData->instanceOffsets + i * 4, boxes + i * 6);
+      }
+      glData->cullTree = cull_tree_create(boxes, glData->instanceCount);
+      free(boxes);
+    }
+    if (!glData->cullTree)
+    {
+      /* Out of memory, draw everything */
+      return glData->instanceCount;
+    }
+  }
 
-  return 1;
+  TRACE_SCOPE("cull");
+  workers = jobs_worker_count(&glData->jobs);
+  if (workers == 0 || glData->instanceCount < CULL_JOB_MIN_OBJECTS)
+  {
+    count = cull_tree_query(glData->cullTree, clip, glData->visibleInstances);
+  }
+  else
+  {
+    /* Subtrees write where their objects are in tree order, close the gaps afterwards */
+    parts = (workers + 1) * CULL_JOB_PARTS_PER_THREAD;
+    if (parts > CULL_JOB_MAX_PARTS)
+    {
+      parts = CULL_JOB_MAX_PARTS;
+    }
+    job.glData = glData;
+    job.clip = clip;
+    parts = cull_tree_split(glData->cullTree, parts, job.roots, job.firsts);
+    jobs_parallel_for(&glData->jobs, cull_job, &job, parts, 1);
+    count = 0;
+    for (i = 0; i < parts; i++)
+    {
+      if (count != job.firsts[i])
+      {
+        memmove(glData->visibleInstances + count, glData->visibleInstances + job.firsts[i], sizeof(int) * job.counts[i]);
+      }
+      count += job.counts[i];
+    }
+  }
+  glData->state.counters.visibleObjects += count;
+  glData->state.counters.culledObjects += glData->instanceCount - count;
+  *visible = glData->visibleInstances;
+  return count;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-// pullic Callbacks
-// intialize callback that gets called once for intialization
-EXPORT_API void intializeGL()
+/*
+ * @ brief Matrices of a range of the instances to draw, gathering the offsets of visible ones.
+ */
+static void mvp_job(void* data, int begin, int end)
 {
-  mGLData.anglePoint.x = 45.f;
-  mGLData.anglePoint.y = 45.f;
-  /* Initialize shaders */
-  init_shaders(&mGLData);
-  /* Initlalize Camera View */
-  init_matrix(mGLData.view);
-  /* Generate and bind Vertex buffer object */
-  generateAndBindBuffer(&(mGLData.vbo));
+  MvpJob* job = (MvpJob*)data;
+  GLData* glData = job->glData;
+  const float* offsets = glData->instanceOffsets;
+  int i, j;
 
-  /* Calculate view aspect */
-  float aspect = (mGLData.width> mGLData.height ? (float)mGLData.width/mGLData.height : (float)mGLData.height/mGLData.width);
-  if (mGLData.width > mGLData.height)
+  TRACE_SCOPE("mvp_job");
+  if (job->visible)
   {
-    view_set_ortho(mGLData.view, -1.0*aspect, 1.0*aspect, -1.0, 1.0, -1.0, 100.0);
+    for (i = begin; i < end; i++)
+    {
+      memcpy(glData->visibleOffsets + i * 4, glData->instanceOffsets + job->visible[i] * 4, sizeof(float) * 4);
+    }
+    offsets = glData->visibleOffsets;
   }
-  else
+
+  for (i = begin; i < end; i++)
   {
-    view_set_ortho(mGLData.view, -1.0, 1.0, -1.0*aspect, 1.0*aspect, -1.0, 100.0);
+    float* mvp = job->mvps + i * 16;
+    const float scale = offsets[i * 4 + 3];
+    for (j = 0; j < 12; j++)
+    {
+      mvp[j] = job->base[j] * scale;
+    }
   }
+  matrix_transform_points(job->mvps + begin * 16 + 12, 16, job->view, offsets + begin * 4, 4, end - begin);
+}
+
+/*
+ * @ brief Matrices of the count instances to draw, into mvps: view * translate * scale * rotation.
+ * @ details All cubes share the rotation, so the upper 3x3 is (view * rotation) * scale and only
+ *           the translation column differs, one batched point transform per instance.
+ * @ param[in] view    View-projection onto the surface, the instance offsets are not rotated by the
+ *                     cube rotation.
+ * @ param[in] visible Indices of the instances to draw, NULL for all of them.
+ */
+static void update_instance_mvps(GLData* glData, const float view[16], const int* visible, int count,
+                                 float* mvps)
+{
+  MvpJob job;
 
-  glEnable(GL_DEPTH_TEST);
+  job.glData = glData;
+  job.mvps = mvps;
+  job.view = view;
+  job.visible = visible;
+  matrix_multiply(job.base, view, glData->model);
+  jobs_parallel_for(&glData->jobs, mvp_job, &job, count, MVP_JOB_GRAIN);
 }
 
-// draw callback is where all the main GL rendering happens
-EXPORT_API int renderFrameGL()
+/*
+ * @ brief Draw the cube field, instanced on GLES3 and in uniform batches on GLES2.
+ */
+static void render_instanced(GLData* glData)
 {
-  int w, h;
-  w = mGLData.width;
-  h = mGLData.height;
+  const int* visible;
+  int count;
+  int i;
 
-  if( mGLData.windowAngle == 90 || mGLData.windowAngle == 270)
+  if (!init_instancing(glData))
   {
-    glViewport(0, 0, h, w);
+    return;
   }
-  else
+
+  count = cull_instances(glData, glData->camera.viewProjection, &visible);
+  if (count == 0)
   {
-    glViewport(0, 0, w, h);
+    return;
   }
-  glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  init_matrix(mGLData.model);
-  rotate_xyz(mGLData.model, mGLData.anglePoint.x, mGLData.anglePoint.y, mGLData.windowAngle);
-
-  multiply_matrix(mGLData.mvp, mGLData.view, mGLData.model);
-  glUseProgram(mGLData.program);
+  if (glData->glesVersion >= 3)
+  {
+    GLStreamBuffer* stream = &glData->instanceStream;
+    float* mvps;
+    int offset;
 
-  glBindBuffer(GL_ARRAY_BUFFER, mGLData.vbo);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 6, 0);
-  glEnableVertexAttribArray(0);
+    /* The jobs write the matrices straight into this frame's region of the streaming buffer */
+    mvps = (float*)stream_map(stream, &glData->state, &glData->resources, sizeof(float) * 16 * count, &offset);
+    if (!mvps)
+    {
+      return;
+    }
+    update_instance_mvps(glData, glData->camera.viewProjection, visible, count, mvps);
+    if (!stream_unmap(stream))
+    {
+      return;
+    }
 
-  glBindBuffer(GL_ARRAY_BUFFER, mGLData.vbo);
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 6, (void*)(sizeof(float) * 3));
-  glEnableVertexAttribArray(1);
+    state_use_program(&glData->state, glData->instanceProgram);
+    bind_mesh_attributes(glData, glData->vbo, mesh_format_stride((MeshFormat)glData->vertexFormat));
+    state_bind_buffer(&glData->state, GL_ELEMENT_ARRAY_BUFFER, glData->ibo);
+    for (i = 0; i < 4; i++)
+    {
+      state_vertex_attrib_pointer(&glData->state, ATTRIB_INSTANCE + i, stream->buffer, 4, GL_FLOAT, GL_FALSE,
+                                  sizeof(float) * 16, (void*)(size_t)(offset + sizeof(float) * 4 * i));
+      state_enable_attrib(&glData->state, ATTRIB_INSTANCE + i, 1);
+      state_attrib_divisor(&glData->state, ATTRIB_INSTANCE + i, 1);
+    }
 
-  glUniformMatrix4fv(glGetUniformLocation(mGLData.program, "mvpMatrix"), 1, GL_FALSE, mGLData.mvp);
+    glDrawElementsInstanced(GL_TRIANGLES, glData->indexCount, glData->indexType, 0, count);
+    glData->state.counters.drawCalls++;
+    stream_fence(stream);
+  }
+  else
+  {
+    const int stride = mesh_format_stride((MeshFormat)glData->vertexFormat);
 
-  /* Render primitives from array data*/
-  glDrawArrays(GL_TRIANGLES, 0, 36);
+    update_instance_mvps(glData, glData->camera.viewProjection, visible, count, glData->instanceMvps);
+    state_use_program(&glData->state, glData->instanceProgram);
+    bind_mesh_attributes(glData, glData->instanceVbo, stride + 4);
+    state_vertex_attrib_pointer(&glData->state, ATTRIB_INSTANCE, glData->instanceVbo, 1, GL_UNSIGNED_BYTE, GL_FALSE,
+                                stride + 4, (void*)(size_t)stride);
+    state_enable_attrib(&glData->state, ATTRIB_INSTANCE, 1);
+    state_bind_buffer(&glData->state, GL_ELEMENT_ARRAY_BUFFER, glData->instanceIbo);
 
-  return 1;
+    for (i = 0; i < count; i += glData->instanceBatchSize)
+    {
+      int batch = count - i < glData->instanceBatchSize ? count - i : glData->instanceBatchSize;
+      glUniformMatrix4fv(glData->instanceMvpLocation, batch, GL_FALSE, glData->instanceMvps + i * 16);
+      glDrawElements(GL_TRIANGLES, glData->indexCount * batch, glData->instanceIndexType, 0);
+      glData->state.counters.drawCalls++;
+    }
+  }
 }
 
+/*
+ * @ brief Draw the single cube (or mesh).
+ */
+static void render_single(GLData* glData)
+{
+  int i;
+
+  state_use_program(&glData->state, glData->program);
 
-// delete callback gets called when glview is deleted
-EXPORT_API void terminateGL()
+  bind_mesh_attributes(glData, glData->vbo, mesh_format_stride((MeshFormat)glData->vertexFormat));
+  for (i = 0; i < 4; i++)
+  {
+    /* Left enabled by the cube field */
+    state_enable_attrib(&glData->state, ATTRIB_INSTANCE + i, 0);
+  }
+  state_bind_buffer(&glData->state, GL_ELEMENT_ARRAY_BUFFER, glData->ibo);
+
+  /* The uniform keeps its value in the program, recompute and upload only when the cube or the camera moved */
+  if (!glData->mvpUploaded || glData->mvpCameraVersion != glData->camera.version ||
+      glData->mvpModelVersion != glData->modelVersion)
+  {
+    matrix_multiply(glData->mvp, glData->camera.viewProjection, glData->model);
+    glData->mvpModelVersion = glData->modelVersion;
+    glData->mvpCameraVersion = glData->camera.version;
+    glUniformMatrix4fv(glData->mvpLocation, 1, GL_FALSE, glData->mvp);
+    glData->mvpUploaded = 1;
+    glData->state.counters.issued++;
+  }
+  else
+  {
+    glData->state.counters.skipped++;
+  }
+
+  /* Render indexed primitives */
+  glDrawElements(GL_TRIANGLES, glData->indexCount, glData->indexType, 0);
+  glData->state.counters.drawCalls++;
+}
+
+/*
+ * @ brief Have the next frame drawn in render on demand mode, from any thread.
+ * @ details Stored after the state it announces, renderFrameGL() takes the flag before reading that state.
+ */
+static void mark_dirty(GLData* glData)
 {
-  glDeleteShader(mGLData.vtx_shader);
-  glDeleteShader(mGLData.fgmt_shader);
-  glDeleteProgram(mGLData.program);
-  glDeleteBuffers(1, &mGLData.vbo);
+  __atomic_store_n(&glData->dirty, true, __ATOMIC_RELEASE);
 }
 
-EXPORT_API void updateTouchEventState( bool down )
+/*
+ * @ brief Turn the cube by a drag of dx, dy pixels, one degree per pixel.
+ * @ details orientation = rotateX(dy) x orientation x rotateY(dx) keeps the rotateX(ax) x rotateY(ay)
+ *          the cube angles used to accumulate, without their growing values.
+ */
+static void turn_cube(float orientation[4], float dx, float dy)
 {
-  mGLData.mouse_down = down;
+  float turn[4];
+
+  if (dy != 0.0f)
+  {
+    quaternion_rotation(turn, 1.0f, 0.0f, 0.0f, dy);
+    quaternion_multiply(orientation, turn, orientation);
+  }
+  if (dx != 0.0f)
+  {
+    quaternion_rotation(turn, 0.0f, 1.0f, 0.0f, dx);
+    quaternion_multiply(orientation, orientation, turn);
+  }
 }
 
-EXPORT_API void updateTouchPosition(int x, int y)
+/*
+ * @ brief Window position on the arcball, the sphere inscribed in the window facing the viewer.
+ * @ details Positions outside the sphere are pulled onto its rim.
+ */
+static void arcball_point(const GLData* glData, FloatPoint position, float point[3])
 {
-  float dx = 0;
-  float dy = 0;
-  mGLData.curPoint.x = (float)x;
-  mGLData.curPoint.y = (float)y;
+  const int width = __atomic_load_n(&glData->width, __ATOMIC_RELAXED);
+  const int height = __atomic_load_n(&glData->height, __ATOMIC_RELAXED);
+  const int shortSide = width < height ? width : height;
+  const float radius = shortSide > 0 ? shortSide * 0.5f : 1.0f;
+  float length;
 
-  if( mGLData.mouse_down == true )
+  point[0] = (position.x - width * 0.5f) / radius;
+  point[1] = (height * 0.5f - position.y) / radius;
+  length = point[0] * point[0] + point[1] * point[1];
+  if (length < 1.0f)
   {
-    dx = mGLData.curPoint.x - mGLData.prevPoint.x;
-    dy = mGLData.curPoint.y - mGLData.prevPoint.y;
-    mGLData.anglePoint.x += dy;
-    mGLData.anglePoint.y += dx;
+    point[2] = sqrtf(1.0f - length);
+  }
+  else
+  {
+    length = sqrtf(length);
+    point[0] /= length;
+    point[1] /= length;
+    point[2] = 0.0f;
   }
-  mGLData.prevPoint.x = mGLData.curPoint.x;
-  mGLData.prevPoint.y = mGLData.curPoint.y;
 }
 
-EXPORT_API void rotationCube(int x, int y)
+/*
+ * @ brief Turn the cube with the arcball by a drag from one window position to another.
+ */
+static void arcball_turn(const GLData* glData, float orientation[4], FloatPoint from, FloatPoint to)
 {
-  float dx = x;
-  float dy = y;
-  mGLData.anglePoint.x += dy;
-  mGLData.anglePoint.y += dx;
+  float start[3], end[3];
+  float turn[4];
+
+  arcball_point(glData, from, start);
+  arcball_point(glData, to, end);
+  quaternion_between(turn, start, end);
+  quaternion_multiply(orientation, turn, orientation);
 }
 
-EXPORT_API void updateWindowSize(int w, int h)
+/*
+ * @ brief Draw the cube at displayOrientation, its matrix is recomputed only when it changed.
+ */
+static void update_model(GLData* glData, const float displayOrientation[4])
 {
-  mGLData.width = w;
-  mGLData.height = h;
+  if (memcmp(displayOrientation, glData->displayOrientation, sizeof(glData->displayOrientation)) != 0)
+  {
+    memcpy(glData->displayOrientation, displayOrientation, sizeof(glData->displayOrientation));
+    matrix_from_quaternion(glData->model, glData->displayOrientation);
+    glData->modelVersion++;
+    mark_dirty(glData);
+  }
 }
 
-EXPORT_API void updateWindowRotationAngle(int angle)
+/*
+ * @ brief Apply the input queued since the last frame as one rotation, then predict the drag.
+ * @ details Motion samples while touching update a smoothed velocity; the predicted rotation is
+ *          velocity * (sample age + lead), recomputed every frame from the real angle so a wrong
+ *          guess never accumulates. A resting finger or a release drops the prediction.
+ */
+static void apply_input(GLData* glData)
+{
+  GLInputEvent event;
+  float dx = 0.0f;
+  float dy = 0.0f;
+  float rx = 0.0f;
+  float ry = 0.0f;
+  float px = 0.0f;
+  float py = 0.0f;
+  unsigned int events = 0;
+  const int arcball = glData->arcball && glData->camera.controller == GL_CAMERA_CONTROL_MODEL;
+  int turned = 0;
+  float displayOrientation[4];
+  TRACE_SCOPE("input");
+
+  while (input_queue_pop(&glData->input, &event))
+  {
+    events++;
+    switch (event.type)
+    {
+      case INPUT_EVENT_TOUCH_DOWN:
+        glData->mouse_down = true;
+        glData->velocity.x = 0.0f;
+        glData->velocity.y = 0.0f;
+        glData->lastMotionTime = event.time;
+        break;
+      case INPUT_EVENT_TOUCH_UP:
+        glData->mouse_down = false;
+        break;
+      case INPUT_EVENT_MOTION:
+        glData->curPoint.x = (float)event.x;
+        glData->curPoint.y = (float)event.y;
+        if( glData->mouse_down == true )
+        {
+          float mx = glData->curPoint.x - glData->prevPoint.x;
+          float my = glData->curPoint.y - glData->prevPoint.y;
+          double dt = event.time - glData->lastMotionTime;
+
+          dx += mx;
+          dy += my;
+          if (arcball && (mx != 0.0f || my != 0.0f))
+          {
+            /* Every sample turns the cube along its own arc */
+            arcball_turn(glData, glData->orientation, glData->prevPoint, glData->curPoint);
+            turned = 1;
+          }
+          if (dt > 0.0)
+          {
+            glData->velocity.x += (mx / (float)dt - glData->velocity.x) * PREDICTION_SMOOTHING;
+            glData->velocity.y += (my / (float)dt - glData->velocity.y) * PREDICTION_SMOOTHING;
+          }
+          glData->lastMotionTime = event.time;
+        }
+        glData->prevPoint.x = glData->curPoint.x;
+        glData->prevPoint.y = glData->curPoint.y;
+        break;
+      case INPUT_EVENT_ROTATE:
+        rx += (float)event.x;
+        ry += (float)event.y;
+        break;
+    }
+  }
+
+  glData->state.counters.inputEvents += events;
+  TRACE_COUNTER("input_events", events);
+
+  /* A camera controller takes the drags, the cube then turns by rotationCube() only */
+  if (glData->camera.controller != GL_CAMERA_CONTROL_MODEL)
+  {
+    const int width = __atomic_load_n(&glData->width, __ATOMIC_RELAXED);
+    const int height = __atomic_load_n(&glData->height, __ATOMIC_RELAXED);
+    const int shortSide = width < height ? width : height;
+    if ((dx != 0.0f || dy != 0.0f) && camera_drag(&glData->camera, dx, dy, shortSide))
+    {
+      mark_dirty(glData);
+    }
+    dx = 0.0f;
+    dy = 0.0f;
+  }
+  else if (arcball)
+  {
+    dx = 0.0f;
+    dy = 0.0f;
+  }
+  dx += rx;
+  dy += ry;
+
+  if (dx != 0.0f || dy != 0.0f)
+  {
+    turn_cube(glData->orientation, dx, dy);
+    turned = 1;
+  }
+  if (turned)
+  {
+    quaternion_normalize(glData->orientation);
+  }
+
+  if (glData->predictionLead > 0.0f && glData->mouse_down && glData->camera.controller == GL_CAMERA_CONTROL_MODEL)
+  {
+    double age = input_time_ms() - glData->lastMotionTime;
+    if (age < PREDICTION_REST_MS)
+    {
+      float lead = (float)age + glData->predictionLead;
+      if (lead > PREDICTION_MAX_MS)
+      {
+        lead = PREDICTION_MAX_MS;
+      }
+      px = glData->velocity.x * lead;
+      py = glData->velocity.y * lead;
+    }
+  }
+
+  memcpy(displayOrientation, glData->orientation, sizeof(displayOrientation));
+  if (px != 0.0f || py != 0.0f)
+  {
+    if (arcball)
+    {
+      FloatPoint predicted;
+      predicted.x = glData->curPoint.x + px;
+      predicted.y = glData->curPoint.y + py;
+      arcball_turn(glData, displayOrientation, glData->curPoint, predicted);
+    }
+    else
+    {
+      turn_cube(displayOrientation, px, py);
+    }
+  }
+  update_model(glData, displayOrientation);
+}
+
+/*
+ * @ brief Delete every GL object of the instance, on the context it was initialized with.
+ * @ details Objects are deleted by their owners first; the registry then reclaims whatever a code
+ *          path forgot, so nothing survives a terminate or re-initialization either way.
+ * @ param[in] contextLost The objects went away with their context, forget them without calling GL.
+ *                        Also done when another context is current: the names are only valid on
+ *                        their own, on any other they may belong to unrelated objects.
+ */
+static void release_gl_objects(GLData* glData, int contextLost)
+{
+  GLResourceRegistry* resources = &glData->resources;
+
+  if (!contextLost && eglGetCurrentContext() != (EGLContext)glData->context)
+  {
+    contextLost = 1;
+  }
+  if (contextLost)
+  {
+    /* The deletes below only clear the names then */
+    resource_forget_all(resources);
+  }
+
+  resource_delete(resources, GL_RESOURCE_SHADER, &glData->vtx_shader);
+  resource_delete(resources, GL_RESOURCE_SHADER, &glData->fgmt_shader);
+  resource_delete(resources, GL_RESOURCE_PROGRAM, &glData->program);
+  resource_delete(resources, GL_RESOURCE_BUFFER, &glData->vbo);
+  resource_delete(resources, GL_RESOURCE_BUFFER, &glData->ibo);
+
+  resource_delete(resources, GL_RESOURCE_SHADER, &glData->instanceVtxShader);
+  resource_delete(resources, GL_RESOURCE_SHADER, &glData->instanceFgmtShader);
+  resource_delete(resources, GL_RESOURCE_PROGRAM, &glData->instanceProgram);
+  stream_terminate(&glData->instanceStream, resources, contextLost);
+  resource_delete(resources, GL_RESOURCE_BUFFER, &glData->instanceVbo);
+  resource_delete(resources, GL_RESOURCE_BUFFER, &glData->instanceIbo);
+  glData->instancingFailed = 0;
+
+  timing_terminate(&glData->timing, contextLost);
+  capture_terminate(&glData->capture, resources, contextLost);
+
+  resource_release_all(resources);
+
+  /* Deleted names may be reused by the next initialization */
+  state_invalidate(&glData->state);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// pullic Callbacks
+// Each GLData instance is an independent scene; its GL objects belong to the context that was
+// current when intializeGLInstance() was called, so render/terminate it with the same context.
+EXPORT_API GLData* createGLInstance()
+{
+  return (GLData*)calloc(1, sizeof(GLData));
+}
+
+EXPORT_API void destroyGLInstance(GLData* glData)
+{
+  if (glData && glData != &mGLData)
+  {
+    free(glData->instanceOffsets);
+    free(glData->instanceMvps);
+    free(glData->instanceStream.staging);
+    free(glData->visibleInstances);
+    free(glData->visibleOffsets);
+    capture_destroy(&glData->capture);
+    resource_terminate(&glData->resources);
+    snapshot_clear(&glData->snapshot);
+    cull_tree_destroy(glData->cullTree);
+    jobs_destroy(&glData->jobs);
+    free(glData->meshPath);
+    free(glData);
+  }
+}
+
+EXPORT_API int setInstanceCountInstance(GLData* glData, int count)
+{
+  float* offsets;
+  float* mvps;
+  int* visible;
+  float* visibleOffsets;
+
+  mark_dirty(glData);
+  cull_tree_destroy(glData->cullTree);
+  glData->cullTree = NULL;
+  if (count <= 1)
+  {
+    glData->instanceCount = 1;
+    return 1;
+  }
+
+  offsets = (float*)realloc(glData->instanceOffsets, sizeof(float) * 4 * count);
+  if (offsets)
+  {
+    glData->instanceOffsets = offsets;
+  }
+  mvps = (float*)realloc(glData->instanceMvps, sizeof(float) * 16 * count);
+  if (mvps)
+  {
+    glData->instanceMvps = mvps;
+  }
+  visible = (int*)realloc(glData->visibleInstances, sizeof(int) * count);
+  if (visible)
+  {
+    glData->visibleInstances = visible;
+  }
+  visibleOffsets = (float*)realloc(glData->visibleOffsets, sizeof(float) * 4 * count);
+  if (visibleOffsets)
+  {
+    glData->visibleOffsets = visibleOffsets;
+  }
+  if (!offsets || !mvps || !visible || !visibleOffsets)
+  {
+    glData->instanceCount = 1;
+    return 0;
+  }
+
+  glData->instanceCount = count;
+  layout_instances(glData);
+  return 1;
+}
+
+EXPORT_API int setInstanceTransformInstance(GLData* glData, int index, float x, float y, float z, float scale)
+{
+  float* offset;
+
+  if (glData->instanceCount <= 1 || index < 0 || index >= glData->instanceCount)
+  {
+    return 0;
+  }
+
+  offset = glData->instanceOffsets + index * 4;
+  offset[0] = x;
+  offset[1] = y;
+  offset[2] = z;
+  offset[3] = scale;
+  if (glData->cullTree)
+  {
+    float box[6];
+    instance_box(glData, offset, box);
+    cull_tree_update(glData->cullTree, index, box);
+  }
+  mark_dirty(glData);
+  return 1;
+}
+
+EXPORT_API void setFrustumCullingInstance(GLData* glData, bool enable)
+{
+  glData->cullingDisabled = !enable;
+  mark_dirty(glData);
+}
+
+EXPORT_API int setWorkerThreadCount(int count)
+{
+  return jobs_set_worker_count(count);
+}
+
+EXPORT_API void setRenderOnDemandInstance(GLData* glData, bool enable)
+{
+  glData->renderOnDemand = enable;
+}
+
+EXPORT_API void requestRenderInstance(GLData* glData)
+{
+  mark_dirty(glData);
+}
+
+EXPORT_API void setInputPredictionInstance(GLData* glData, float leadMs)
+{
+  glData->predictionLead = leadMs > 0.0f ? leadMs : 0.0f;
+}
+
+EXPORT_API void setFrameTimingEnabledInstance(GLData* glData, bool enable)
+{
+  glData->timing.enabled = enable;
+}
+
+EXPORT_API int getFrameTimingStatsInstance(GLData* glData, GLTimingPass pass, GLTimingStats* stats)
+{
+  if (pass < 0 || pass >= GL_TIMING_PASS_COUNT || !stats)
+  {
+    return 0;
+  }
+  return timing_stats(&glData->timing, pass, stats);
+}
+
+EXPORT_API void setOffscreenTargetInstance(GLData* glData, int width, int height)
+{
+  if (capture_set_target(&glData->capture, width, height))
+  {
+    mark_dirty(glData);
+  }
+}
+
+EXPORT_API unsigned int getOffscreenTextureInstance(GLData* glData)
+{
+  return glData->capture.colorTexture;
+}
+
+EXPORT_API int requestFrameCaptureInstance(GLData* glData, const char* path, GLCaptureFormat format)
+{
+  if (!capture_request(&glData->capture, path, format))
+  {
+    return 0;
+  }
+  /* Render on demand would not draw a frame to capture otherwise */
+  mark_dirty(glData);
+  return 1;
+}
+
+EXPORT_API int flushFrameCapturesInstance(GLData* glData)
+{
+  return capture_flush(&glData->capture);
+}
+
+EXPORT_API unsigned int getDroppedInputEventsInstance(GLData* glData)
+{
+  return input_queue_dropped(&glData->input);
+}
+
+EXPORT_API void getGLStateCountersInstance(GLData* glData, GLStateCounters* counters)
+{
+  *counters = glData->state.counters;
+}
+
+EXPORT_API void getGLResourceStatsInstance(GLData* glData, GLResourceStats* stats)
+{
+  *stats = glData->resources.stats;
+  stats->snapshotBytes = glData->snapshot.size;
+}
+
+EXPORT_API void resetGLStateCountersInstance(GLData* glData)
+{
+  memset(&glData->state.counters, 0, sizeof(glData->state.counters));
+}
+
+EXPORT_API void invalidateGLStateInstance(GLData* glData)
+{
+  state_invalidate(&glData->state);
+}
+
+EXPORT_API int setProgramCacheDirectory(const char* directory)
+{
+  return program_set_cache_directory(directory);
+}
+
+EXPORT_API int setMeshFileInstance(GLData* glData, const char* path)
+{
+  char* copy = NULL;
+
+  if (path)
+  {
+    copy = strdup(path);
+    if (!copy)
+    {
+      return 0;
+    }
+  }
+  free(glData->meshPath);
+  glData->meshPath = copy;
+  return 1;
+}
+
+// intialize callback that gets called once for intialization
+EXPORT_API void intializeGLInstance(GLData* glData)
+{
+  const char* version = (const char*)glGetString(GL_VERSION);
+  /* The scene as it was drawn last, its programs loaded from the snapshot */
+  const bool restore = glData->initialized || glData->contextLost;
+  TRACE_SCOPE("init");
+
+  /* Initialized again without terminateGL(), e.g. for a recreated window: start over instead of
+   * piling up a second set of objects */
+  if (glData->initialized)
+  {
+    release_gl_objects(glData, 0);
+  }
+  glData->contextLost = false;
+  glData->context = (void*)eglGetCurrentContext();
+
+  /* Nothing is known about a new context, and nothing has been drawn into it */
+  state_invalidate(&glData->state);
+  mark_dirty(glData);
+  if (!version || sscanf(version, "OpenGL ES %d", &glData->glesVersion) != 1)
+  {
+    glData->glesVersion = 2;
+  }
+
+  /* Half float positions are core in GLES3 and an extension in GLES2 */
+  const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+  if (glData->glesVersion >= 3 || (extensions && strstr(extensions, "GL_OES_vertex_half_float")))
+  {
+    glData->vertexFormat = MESH_FORMAT_HALF_FLOAT;
+  }
+  else
+  {
+    glData->vertexFormat = MESH_FORMAT_FLOAT;
+  }
+
+  snapshot_begin(&glData->snapshot, glData->glesVersion);
+
+  if (!restore)
+  {
+    glData->orientation[0] = 0.0f;
+    glData->orientation[1] = 0.0f;
+    glData->orientation[2] = 0.0f;
+    glData->orientation[3] = 1.0f;
+    turn_cube(glData->orientation, 45.f, 45.f);
+    update_model(glData, glData->orientation);
+    camera_reset(&glData->camera);
+  }
+  /* Initialize shaders */
+  init_shaders(glData);
+  /* Generate and bind Vertex buffer object */
+  generateAndBindBuffer(glData);
+  /* A restored field is uploaded here with the rest, not while drawing the first frame */
+  if (restore && glData->instanceCount > 1)
+  {
+    init_instancing(glData);
+  }
+
+  state_depth_test(&glData->state, 1);
+  glData->initialized = true;
+}
+
+// draw callback is where all the main GL rendering happens
+EXPORT_API int renderFrameGLInstance(GLData* glData)
+{
+  int w, h, angle;
+  double start;
+  int gpuTimed;
+  int offscreen;
+  bool dirty;
+  TRACE_SCOPE("render");
+
+  start = timing_cpu_begin(&glData->timing);
+  apply_input(glData);
+  timing_cpu_end(&glData->timing, GL_TIMING_CPU_INPUT, start);
+
+  /* Readbacks of earlier frames that are done by now, without waiting */
+  capture_poll(&glData->capture, 0);
+
+  /* Nothing to draw when the shaders failed to build */
+  if (!glData->program)
+  {
+    return 0;
+  }
+
+  /* Take the flag before reading the window state: a resize landing after this marks the
+   * scene dirty again and is drawn by the next frame */
+  dirty = __atomic_exchange_n(&glData->dirty, false, __ATOMIC_ACQUIRE);
+
+  /* Keep showing the last frame when nothing changed since */
+  if (glData->renderOnDemand && !dirty)
+  {
+    glData->state.counters.idleFrames++;
+    return 0;
+  }
+  w = __atomic_load_n(&glData->width, __ATOMIC_RELAXED);
+  h = __atomic_load_n(&glData->height, __ATOMIC_RELAXED);
+  angle = __atomic_load_n(&glData->windowAngle, __ATOMIC_RELAXED);
+
+  start = timing_cpu_begin(&glData->timing);
+  gpuTimed = timing_gpu_begin(&glData->timing);
+
+  glData->state.counters.frames++;
+  offscreen = capture_begin_frame(&glData->capture, &glData->resources);
+  if (offscreen)
+  {
+    /* The texture has no surface orientation to rotate into */
+    w = glData->capture.width;
+    h = glData->capture.height;
+    angle = 0;
+  }
+  camera_update(&glData->camera, w, h, angle);
+  if (angle == 90 || angle == 270)
+  {
+    state_viewport(&glData->state, 0, 0, h, w);
+  }
+  else
+  {
+    state_viewport(&glData->state, 0, 0, w, h);
+  }
+  state_clear_color(&glData->state, 1.0f, 1.0f, 1.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  if (glData->instanceCount > 1)
+  {
+    render_instanced(glData);
+  }
+  else
+  {
+    render_single(glData);
+  }
+
+  if (angle == 90 || angle == 270)
+  {
+    capture_end_frame(&glData->capture, &glData->resources, glData->glesVersion, h, w);
+  }
+  else
+  {
+    capture_end_frame(&glData->capture, &glData->resources, glData->glesVersion, w, h);
+  }
+
+  timing_gpu_end(&glData->timing, gpuTimed);
+  timing_cpu_end(&glData->timing, GL_TIMING_CPU_RENDER, start);
+  return offscreen ? 0 : 1;
+}
+
+
+// delete callback gets called when glview is deleted
+EXPORT_API void terminateGLInstance(GLData* glData)
+{
+  TRACE_SCOPE("terminate");
+  /* Terminating twice, or without initializing, has nothing to release */
+  if (!glData->initialized)
+  {
+    return;
+  }
+  release_gl_objects(glData, 0);
+  snapshot_clear(&glData->snapshot);
+  jobs_destroy(&glData->jobs);
+  glData->initialized = false;
+}
+
+EXPORT_API void setCameraProjectionInstance(GLData* glData, GLCameraProjection projection, float fovY)
+{
+  if (projection != glData->camera.projectionType || fovY != glData->camera.fovY)
+  {
+    glData->camera.projectionType = projection;
+    glData->camera.fovY = fovY;
+    /* The perspective eye moves back from the target, the orthographic one sits on it */
+    glData->camera.projectionValid = false;
+    glData->camera.viewValid = false;
+    mark_dirty(glData);
+  }
+}
+
+EXPORT_API void setCameraControllerInstance(GLData* glData, GLCameraController controller)
+{
+  glData->camera.controller = controller;
+}
+
+EXPORT_API void setArcballRotationInstance(GLData* glData, bool enable)
+{
+  glData->arcball = enable;
+}
+
+EXPORT_API void resetCameraInstance(GLData* glData)
+{
+  camera_reset(&glData->camera);
+  mark_dirty(glData);
+}
+
+EXPORT_API int getCameraMatricesInstance(GLData* glData, float view[16], float projection[16], float viewProjection[16])
+{
+  if (glData->camera.version == 0)
+  {
+    return 0;
+  }
+  if (view)
+  {
+    memcpy(view, glData->camera.view, sizeof(glData->camera.view));
+  }
+  if (projection)
+  {
+    memcpy(projection, glData->camera.projection, sizeof(glData->camera.projection));
+  }
+  if (viewProjection)
+  {
+    memcpy(viewProjection, glData->camera.viewProjection, sizeof(glData->camera.viewProjection));
+  }
+  return 1;
+}
+
+EXPORT_API void notifyGLContextLostInstance(GLData* glData)
+{
+  if (!glData->initialized)
+  {
+    return;
+  }
+  release_gl_objects(glData, 1);
+  glData->initialized = false;
+  glData->contextLost = true;
+}
+
+// Input may arrive on another thread than rendering, it is queued and applied by renderFrameGLInstance()
+EXPORT_API void updateTouchEventStateInstance(GLData* glData, bool down)
+{
+  input_queue_push(&glData->input, down ? INPUT_EVENT_TOUCH_DOWN : INPUT_EVENT_TOUCH_UP, 0, 0);
+}
+
+EXPORT_API void updateTouchPositionInstance(GLData* glData, int x, int y)
+{
+  input_queue_push(&glData->input, INPUT_EVENT_MOTION, x, y);
+}
+
+EXPORT_API void rotationCubeInstance(GLData* glData, int x, int y)
+{
+  if (x != 0 || y != 0)
+  {
+    input_queue_push(&glData->input, INPUT_EVENT_ROTATE, x, y);
+  }
+}
+
+// The window state is written by the caller's thread and read by renderFrameGLInstance()
+EXPORT_API void updateWindowSizeInstance(GLData* glData, int w, int h)
+{
+  if (w != __atomic_load_n(&glData->width, __ATOMIC_RELAXED) || h != __atomic_load_n(&glData->height, __ATOMIC_RELAXED))
+  {
+    TRACE_INSTANT("resize");
+    __atomic_store_n(&glData->width, w, __ATOMIC_RELAXED);
+    __atomic_store_n(&glData->height, h, __ATOMIC_RELAXED);
+    mark_dirty(glData);
+  }
+}
+
+EXPORT_API void updateWindowRotationAngleInstance(GLData* glData, int angle)
+{
+  if (angle != __atomic_load_n(&glData->windowAngle, __ATOMIC_RELAXED))
+  {
+    TRACE_INSTANT("rotate");
+    __atomic_store_n(&glData->windowAngle, angle, __ATOMIC_RELAXED);
+    mark_dirty(glData);
+  }
+}
+
+// Default instance, kept for the NUI P/Invoke bindings which have no handle
+EXPORT_API void intializeGL()
+{
+  intializeGLInstance(&mGLData);
+}
+
+EXPORT_API int renderFrameGL()
+{
+  return renderFrameGLInstance(&mGLData);
+}
+
+EXPORT_API void terminateGL()
+{
+  terminateGLInstance(&mGLData);
+}
+
+EXPORT_API void updateTouchEventState( bool down )
+{
+  updateTouchEventStateInstance(&mGLData, down);
+}
+
+EXPORT_API void updateTouchPosition(int x, int y)
+{
+  updateTouchPositionInstance(&mGLData, x, y);
+}
+
+EXPORT_API void rotationCube(int x, int y)
+{
+  rotationCubeInstance(&mGLData, x, y);
+}
+
+EXPORT_API void updateWindowSize(int w, int h)
+{
+  updateWindowSizeInstance(&mGLData, w, h);
+}
+
+EXPORT_API void updateWindowRotationAngle(int angle)
+{
+  updateWindowRotationAngleInstance(&mGLData, angle);
+}
+
+EXPORT_API int setInstanceCount(int count)
+{
+  return setInstanceCountInstance(&mGLData, count);
+}
+
+EXPORT_API int setMeshFile(const char* path)
+{
+  return setMeshFileInstance(&mGLData, path);
+}
+
+EXPORT_API void setCameraProjection(GLCameraProjection projection, float fovY)
+{
+  setCameraProjectionInstance(&mGLData, projection, fovY);
+}
+
+EXPORT_API void setCameraController(GLCameraController controller)
+{
+  setCameraControllerInstance(&mGLData, controller);
+}
+
+EXPORT_API void setArcballRotation(bool enable)
+{
+  setArcballRotationInstance(&mGLData, enable);
+}
+
+EXPORT_API void resetCamera()
+{
+  resetCameraInstance(&mGLData);
+}
+
+EXPORT_API int getCameraMatrices(float view[16], float projection[16], float viewProjection[16])
+{
+  return getCameraMatricesInstance(&mGLData, view, projection, viewProjection);
+}
+
+EXPORT_API void notifyGLContextLost()
+{
+  notifyGLContextLostInstance(&mGLData);
+}
+
+EXPORT_API void getGLStateCounters(GLStateCounters* counters)
+{
+  getGLStateCountersInstance(&mGLData, counters);
+}
+
+EXPORT_API void getGLResourceStats(GLResourceStats* stats)
+{
+  getGLResourceStatsInstance(&mGLData, stats);
+}
+
+EXPORT_API void resetGLStateCounters()
+{
+  resetGLStateCountersInstance(&mGLData);
+}
+
+EXPORT_API void invalidateGLState()
+{
+  invalidateGLStateInstance(&mGLData);
+}
+
+EXPORT_API int setInstanceTransform(int index, float x, float y, float z, float scale)
+{
+  return setInstanceTransformInstance(&mGLData, index, x, y, z, scale);
+}
+
+EXPORT_API void setFrustumCulling(bool enable)
+{
+  setFrustumCullingInstance(&mGLData, enable);
+}
+
+EXPORT_API void setRenderOnDemand(bool enable)
+{
+  setRenderOnDemandInstance(&mGLData, enable);
+}
+
+EXPORT_API void requestRender()
+{
+  requestRenderInstance(&mGLData);
+}
+
+EXPORT_API void setInputPrediction(float leadMs)
+{
+  setInputPredictionInstance(&mGLData, leadMs);
+}
+
+EXPORT_API void setFrameTimingEnabled(bool enable)
+{
+  setFrameTimingEnabledInstance(&mGLData, enable);
+}
+
+EXPORT_API int getFrameTimingStats(GLTimingPass pass, GLTimingStats* stats)
+{
+  return getFrameTimingStatsInstance(&mGLData, pass, stats);
+}
+
+EXPORT_API void setOffscreenTarget(int width, int height)
+{
+  setOffscreenTargetInstance(&mGLData, width, height);
+}
+
+EXPORT_API unsigned int getOffscreenTexture(void)
+{
+  return getOffscreenTextureInstance(&mGLData);
+}
+
+EXPORT_API int requestFrameCapture(const char* path, GLCaptureFormat format)
+{
+  return requestFrameCaptureInstance(&mGLData, path, format);
+}
+
+EXPORT_API int flushFrameCaptures(void)
+{
+  return flushFrameCapturesInstance(&mGLData);
+}
+
+EXPORT_API int dumpTrace(const char* path)
+{
+  return trace_dump(path);
+}
+
+EXPORT_API void resetTrace()
+{
+  trace_reset();
+}
+
+EXPORT_API unsigned int getDroppedInputEvents()
 {
-  mGLData.windowAngle = angle;
+  return getDroppedInputEventsInstance(&mGLData);
 }
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <dlfcn.h>
+#include <GLES3/gl3.h>
+
+#include "call-counter.h"
+
+/* GL entry points that return nothing: X(name, params, args) */
+#define GL_VOID_FUNCTIONS(X) \
+  X(glActiveTexture, (GLenum texture), (texture)) \
+  X(glAttachShader, (GLuint program, GLuint shader), (program, shader)) \
+  X(glBindAttribLocation, (GLuint program, GLuint index, const GLchar* name), (program, index, name)) \
+  X(glBindBuffer, (GLenum target, GLuint buffer), (target, buffer)) \
+  X(glBindFramebuffer, (GLenum target, GLuint framebuffer), (target, framebuffer)) \
+  X(glBindRenderbuffer, (GLenum target, GLuint renderbuffer), (target, renderbuffer)) \
+  X(glBindTexture, (GLenum target, GLuint texture), (target, texture)) \
+  X(glBindVertexArray, (GLuint array), (array)) \
+  X(glBufferData, (GLenum target, GLsizeiptr size, const void* data, GLenum usage), (target, size, data, usage)) \
+  X(glBufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void* data), (target, offset, size, data)) \
+  X(glClear, (GLbitfield mask), (mask)) \
+  X(glClearColor, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha)) \
+  X(glCompileShader, (GLuint shader), (shader)) \
+  X(glDeleteBuffers, (GLsizei n, const GLuint* buffers), (n, buffers)) \
+  X(glDeleteFramebuffers, (GLsizei n, const GLuint* framebuffers), (n, framebuffers)) \
+  X(glDeleteProgram, (GLuint program), (program)) \
+  X(glDeleteRenderbuffers, (GLsizei n, const GLuint* renderbuffers), (n, renderbuffers)) \
+  X(glDeleteShader, (GLuint shader), (shader)) \
+  X(glDeleteSync, (GLsync sync), (sync)) \
+  X(glDeleteTextures, (GLsizei n, const GLuint* textures), (n, textures)) \
+  X(glDisable, (GLenum cap), (cap)) \
+  X(glDisableVertexAttribArray, (GLuint index), (index)) \
+  X(glDrawArrays, (GLenum mode, GLint first, GLsizei count), (mode, first, count)) \
+  X(glDrawArraysInstanced, (GLenum mode, GLint first, GLsizei count, GLsizei instancecount), (mode, first, count, instancecount)) \
+  X(glDrawElements, (GLenum mode, GLsizei count, GLenum type, const void* indices), (mode, count, type, indices)) \
+  X(glDrawElementsInstanced, (GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount), (mode, count, type, indices, instancecount)) \
+  X(glEnable, (GLenum cap), (cap)) \
+  X(glEnableVertexAttribArray, (GLuint index), (index)) \
+  X(glFramebufferRenderbuffer, (GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer), (target, attachment, renderbuffertarget, renderbuffer)) \
+  X(glFramebufferTexture2D, (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level), (target, attachment, textarget, texture, level)) \
+  X(glGenBuffers, (GLsizei n, GLuint* buffers), (n, buffers)) \
+  X(glGenFramebuffers, (GLsizei n, GLuint* framebuffers), (n, framebuffers)) \
+  X(glGenRenderbuffers, (GLsizei n, GLuint* renderbuffers), (n, renderbuffers)) \
+  X(glGenTextures, (GLsizei n, GLuint* textures), (n, textures)) \
+  X(glGenVertexArrays, (GLsizei n, GLuint* arrays), (n, arrays)) \
+  X(glGetIntegerv, (GLenum pname, GLint* data), (pname, data)) \
+  X(glGetProgramBinary, (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary), (program, bufSize, length, binaryFormat, binary)) \
+  X(glGetProgramInfoLog, (GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog), (program, bufSize, length, infoLog)) \
+  X(glGetProgramiv, (GLuint program, GLenum pname, GLint* params), (program, pname, params)) \
+  X(glGetShaderInfoLog, (GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog), (shader, bufSize, length, infoLog)) \
+  X(glGetShaderiv, (GLuint shader, GLenum pname, GLint* params), (shader, pname, params)) \
+  X(glLinkProgram, (GLuint program), (program)) \
+  X(glProgramBinary, (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length), (program, binaryFormat, binary, length)) \
+  X(glProgramParameteri, (GLuint program, GLenum pname, GLint value), (program, pname, value)) \
+  X(glReadPixels, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels), (x, y, width, height, format, type, pixels)) \
+  X(glRenderbufferStorage, (GLenum target, GLenum internalformat, GLsizei width, GLsizei height), (target, internalformat, width, height)) \
+  X(glShaderSource, (GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length), (shader, count, string, length)) \
+  X(glTexImage2D, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels), (target, level, internalformat, width, height, border, format, type, pixels)) \
+  X(glTexParameteri, (GLenum target, GLenum pname, GLint param), (target, pname, param)) \
+  X(glUniform1f, (GLint location, GLfloat v0), (location, v0)) \
+  X(glUniform4fv, (GLint location, GLsizei count, const GLfloat* value), (location, count, value)) \
+  X(glUniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value)) \
+  X(glUseProgram, (GLuint program), (program)) \
+  X(glVertexAttribDivisor, (GLuint index, GLuint divisor), (index, divisor)) \
+  X(glVertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer), (index, size, type, normalized, stride, pointer)) \
+  X(glViewport, (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height))
+
+/* GL entry points with a return value: X(type, name, params, args) */
+#define GL_RETURN_FUNCTIONS(X) \
+  X(GLenum, glCheckFramebufferStatus, (GLenum target), (target)) \
+  X(GLenum, glClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout), (sync, flags, timeout)) \
+  X(GLuint, glCreateProgram, (void), ()) \
+  X(GLuint, glCreateShader, (GLenum type), (type)) \
+  X(GLsync, glFenceSync, (GLenum condition, GLbitfield flags), (condition, flags)) \
+  X(GLenum, glGetError, (void), ()) \
+  X(GLint, glGetAttribLocation, (GLuint program, const GLchar* name), (program, name)) \
+  X(GLint, glGetUniformLocation, (GLuint program, const GLchar* name), (program, name)) \
+  X(void*, glMapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access), (target, offset, length, access)) \
+  X(GLboolean, glUnmapBuffer, (GLenum target), (target))
+
+#define GL_ENUM_VOID(name, params, args) COUNTER_##name,
+#define GL_ENUM_RETURN(type, name, params, args) COUNTER_##name,
+enum
+{
+  GL_VOID_FUNCTIONS(GL_ENUM_VOID)
+  GL_RETURN_FUNCTIONS(GL_ENUM_RETURN)
+  COUNTER_GL_FUNCTION_COUNT
+};
+
+#define GL_NAME_VOID(name, params, args) #name,
+#define GL_NAME_RETURN(type, name, params, args) #name,
+static const char* sGlFunctionNames[] = {
+  GL_VOID_FUNCTIONS(GL_NAME_VOID)
+  GL_RETURN_FUNCTIONS(GL_NAME_RETURN)
+};
+
+static unsigned long sGlCalls[COUNTER_GL_FUNCTION_COUNT];
+static unsigned long sAllocations;
+static unsigned long sAllocatedBytes;
+static __thread int sCounting;
+
+/* glibc entry points behind malloc and friends */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+
+#define GL_DEFINE_VOID(name, params, args) \
+  void name params \
+  { \
+    static __typeof__(name)* real; \
+    if (!real) \
+    { \
+      real = (__typeof__(name)*)dlsym(RTLD_NEXT, #name); \
+    } \
+    if (sCounting) \
+    { \
+      sGlCalls[COUNTER_##name]++; \
+    } \
+    real args; \
+  }
+
+#define GL_DEFINE_RETURN(type, name, params, args) \
+  type name params \
+  { \
+    static __typeof__(name)* real; \
+    if (!real) \
+    { \
+      real = (__typeof__(name)*)dlsym(RTLD_NEXT, #name); \
+    } \
+    if (sCounting) \
+    { \
+      sGlCalls[COUNTER_##name]++; \
+    } \
+    return real args; \
+  }
+
+GL_VOID_FUNCTIONS(GL_DEFINE_VOID)
+GL_RETURN_FUNCTIONS(GL_DEFINE_RETURN)
+
+void* malloc(size_t size)
+{
+  if (sCounting)
+  {
+    sAllocations++;
+    sAllocatedBytes += size;
+  }
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+  if (sCounting)
+  {
+    sAllocations++;
+    sAllocatedBytes += count * size;
+  }
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+  if (sCounting)
+  {
+    sAllocations++;
+    sAllocatedBytes += size;
+  }
+  return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+  if (sCounting)
+  {
+    sAllocations++;
+    sAllocatedBytes += size;
+  }
+  *ptr = __libc_memalign(alignment, size);
+  return *ptr ? 0 : 12; /* ENOMEM */
+}
+
+void call_counter_enable(int enable)
+{
+  sCounting = enable;
+}
+
+void call_counter_reset(void)
+{
+  int i;
+  for (i = 0; i < COUNTER_GL_FUNCTION_COUNT; i++)
+  {
+    sGlCalls[i] = 0;
+  }
+  sAllocations = 0;
+  sAllocatedBytes = 0;
+}
+
+int call_counter_gl_function_count(void)
+{
+  return COUNTER_GL_FUNCTION_COUNT;
+}
+
+const char* call_counter_gl_function_name(int index)
+{
+  return sGlFunctionNames[index];
+}
+
+unsigned long call_counter_gl_function_calls(int index)
+{
+  return sGlCalls[index];
+}
+
+unsigned long call_counter_gl_calls(void)
+{
+  unsigned long total = 0;
+  int i;
+  for (i = 0; i < COUNTER_GL_FUNCTION_COUNT; i++)
+  {
+    total += sGlCalls[i];
+  }
+  return total;
+}
+
+unsigned long call_counter_allocations(void)
+{
+  return sAllocations;
+}
+
+unsigned long call_counter_allocated_bytes(void)
+{
+  return sAllocatedBytes;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_CALL_COUNTER_H__
+#define __DALI_NATIVEGL_CALL_COUNTER_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * GL call and heap allocation counters.
+ *
+ * The counters interpose the GL entry points and malloc/calloc/realloc from the
+ * executable, so the unmodified library resolves its calls to them. Counting is
+ * only done on the thread that enabled it, which keeps driver worker threads out
+ * of the numbers.
+ */
+
+/*
+ * @ brief Start or stop counting on the calling thread.
+ */
+void call_counter_enable(int enable);
+
+/*
+ * @ brief Reset all counters to zero.
+ */
+void call_counter_reset(void);
+
+/*
+ * @ brief Number of interposed GL entry points.
+ */
+int call_counter_gl_function_count(void);
+
+/*
+ * @ brief Name and call count of the GL entry point at index.
+ */
+const char* call_counter_gl_function_name(int index);
+unsigned long call_counter_gl_function_calls(int index);
+
+/*
+ * @ brief Total GL calls since the last reset.
+ */
+unsigned long call_counter_gl_calls(void);
+
+/*
+ * @ brief Heap allocations and allocated bytes since the last reset.
+ */
+unsigned long call_counter_allocations(void);
+unsigned long call_counter_allocated_bytes(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_CALL_COUNTER_H__ */
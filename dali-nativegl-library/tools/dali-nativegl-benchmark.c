@@ -0,0 +1,585 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Frame-time benchmark for dali-nativegl-library.
+ *
+ * Drives renderFrameGL() through scripted scenarios in a headless EGL context and
+ * writes one JSON document with per-frame CPU time percentiles, GL call counts and
+ * heap allocations. The option names and the JSON layout are stable; new fields may
+ * be added but existing ones keep their meaning ("schema" is bumped otherwise).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <GLES2/gl2.h>
+
+#include <dali-nativegl-library.h>
+
+#include "headless-util.h"
+#include "call-counter.h"
+
+#define BENCHMARK_SCHEMA 1
+
+/* Sparse scenes: SPARSE_SIDE^2 cubes on a grid spanning SPARSE_EXTENT in x and y, the view
+   volume spans [-aspect, aspect] x [-1, 1] so about 2% of them are visible */
+#define SPARSE_SIDE 317
+#define SPARSE_EXTENT 20.0f
+
+typedef struct {
+    int width;
+    int height;
+    int instances;
+    int frame;
+    int cubes;           /* Cubes in the scene, set by the setup */
+    int failed;          /* A step could not run, e.g. no new context */
+} ScenarioState;
+
+typedef struct {
+    const char* name;
+    const char* description;
+    /* Called once before intializeGL(), may be NULL */
+    void (*setup)(ScenarioState* state);
+    /* Called before every measured and warm-up frame */
+    void (*step)(ScenarioState* state);
+} Scenario;
+
+typedef struct {
+    double mean;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+} Summary;
+
+static void step_static(ScenarioState* state);
+static void step_spin(ScenarioState* state);
+static void step_resize(ScenarioState* state);
+static void step_orientation(ScenarioState* state);
+static void setup_field(ScenarioState* state);
+static void setup_on_demand(ScenarioState* state);
+static void step_occasional(ScenarioState* state);
+static void setup_drag(ScenarioState* state);
+static void step_drag(ScenarioState* state);
+static void setup_orbit(ScenarioState* state);
+static void setup_arcball(ScenarioState* state);
+static void setup_sparse(ScenarioState* state);
+static void setup_sparse_no_culling(ScenarioState* state);
+static void step_sparse_moving(ScenarioState* state);
+static void setup_capture(ScenarioState* state);
+static void step_capture(ScenarioState* state);
+static void setup_reinit(ScenarioState* state);
+static void step_reinit(ScenarioState* state);
+static void step_recreate(ScenarioState* state);
+static void step_recover(ScenarioState* state);
+
+static const Scenario sScenarios[] = {
+  { "static",      "unchanged cube, the steady state of an idle window",          NULL,        step_static },
+  { "spin",        "continuous rotationCube() spin, one degree per frame",        NULL,        step_spin },
+  { "resize",      "updateWindowSize() with a different size every frame",        NULL,        step_resize },
+  { "orientation", "updateWindowRotationAngle() cycling 0/90/180/270 every frame", NULL,        step_orientation },
+  { "field",       "spinning field of --instances cubes (setInstanceCount())",    setup_field, step_spin },
+  { "on-demand",   "setRenderOnDemand() with a rotation every 30th frame",        setup_on_demand, step_occasional },
+  { "drag",        "touch drag, 4 updateTouchPosition() per frame (240 Hz input)", setup_drag,  step_drag },
+  { "orbit",       "the drag orbiting a perspective camera around the --instances field", setup_orbit, step_drag },
+  { "arcball",     "the drag turning the cube with setArcballRotation()",        setup_arcball, step_drag },
+  { "sparse",      "100k spinning cubes over 20x the view volume, frustum culled", setup_sparse, step_spin },
+  { "sparse-nocull", "the sparse scene with setFrustumCulling(false)",           setup_sparse_no_culling, step_spin },
+  { "sparse-moving", "the sparse scene with 1% of the cubes moved every frame",  setup_sparse, step_sparse_moving },
+  { "capture",     "spin into an offscreen target, every frame read back to a file", setup_capture, step_capture },
+  { "reinit",      "terminateGL() and intializeGL() every frame, instanced and offscreen", setup_reinit, step_reinit },
+  { "recreate",    "reinit with a new context every frame, the first frame of a new window", setup_reinit, step_recreate },
+  { "recover",     "notifyGLContextLost() and a new context every frame, restored from the snapshot", setup_reinit, step_recover },
+};
+
+#define SCENARIO_COUNT ((int)(sizeof(sScenarios) / sizeof(sScenarios[0])))
+
+/* Current context, replaced by the recreate and recover scenarios */
+static HeadlessContext sContext;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scenarios
+static void step_static(ScenarioState* state)
+{
+}
+
+static void step_spin(ScenarioState* state)
+{
+  rotationCube(1, 1);
+}
+
+static void step_resize(ScenarioState* state)
+{
+  /* Shrink to half size and back in 1/8 steps */
+  static const int scale[] = { 8, 7, 6, 5, 4, 5, 6, 7 };
+  int s = scale[state->frame % 8];
+  updateWindowSize(state->width * s / 8, state->height * s / 8);
+}
+
+static void step_orientation(ScenarioState* state)
+{
+  updateWindowRotationAngle((state->frame % 4) * 90);
+}
+
+static void setup_field(ScenarioState* state)
+{
+  setInstanceCount(state->instances);
+  state->cubes = state->instances;
+}
+
+static void setup_on_demand(ScenarioState* state)
+{
+  setRenderOnDemand(true);
+}
+
+static void step_occasional(ScenarioState* state)
+{
+  if (state->frame % 30 == 0)
+  {
+    rotationCube(1, 1);
+  }
+}
+
+static void setup_drag(ScenarioState* state)
+{
+  updateTouchEventState(true);
+  updateTouchPosition(0, 0);
+}
+
+static void setup_orbit(ScenarioState* state)
+{
+  state->cubes = state->instances;
+  setInstanceCount(state->cubes);
+  setCameraProjection(GL_CAMERA_PERSPECTIVE, 0.0f);
+  setCameraController(GL_CAMERA_CONTROL_ORBIT);
+  setup_drag(state);
+}
+
+static void setup_arcball(ScenarioState* state)
+{
+  setArcballRotation(true);
+  setup_drag(state);
+}
+
+static void setup_sparse(ScenarioState* state)
+{
+  const float spacing = SPARSE_EXTENT / SPARSE_SIDE;
+  int i;
+
+  state->cubes = SPARSE_SIDE * SPARSE_SIDE;
+  setInstanceCount(state->cubes);
+  for (i = 0; i < state->cubes; i++)
+  {
+    setInstanceTransform(i, -SPARSE_EXTENT * 0.5f + spacing * (0.5f + i % SPARSE_SIDE),
+                         -SPARSE_EXTENT * 0.5f + spacing * (0.5f + i / SPARSE_SIDE), 0.0f, spacing * 0.5f);
+  }
+}
+
+static void setup_sparse_no_culling(ScenarioState* state)
+{
+  setup_sparse(state);
+  setFrustumCulling(false);
+}
+
+static void step_sparse_moving(ScenarioState* state)
+{
+  const float spacing = SPARSE_EXTENT / SPARSE_SIDE;
+  const int count = SPARSE_SIDE * SPARSE_SIDE;
+  int i;
+
+  rotationCube(1, 1);
+  /* Every frame a different 1% of the cubes bobs along z */
+  for (i = state->frame % 100; i < count; i += 100)
+  {
+    setInstanceTransform(i, -SPARSE_EXTENT * 0.5f + spacing * (0.5f + i % SPARSE_SIDE),
+                         -SPARSE_EXTENT * 0.5f + spacing * (0.5f + i / SPARSE_SIDE),
+                         (state->frame % 2) ? 0.1f : 0.0f, spacing * 0.5f);
+  }
+}
+
+static void setup_capture(ScenarioState* state)
+{
+  setOffscreenTarget(state->width, state->height);
+}
+
+static void step_capture(ScenarioState* state)
+{
+  /* Measures the readback, not the disk */
+  rotationCube(1, 1);
+  requestFrameCapture("/dev/null", GL_CAPTURE_RAW);
+}
+
+static void setup_reinit(ScenarioState* state)
+{
+  /* Every kind of object: instancing buffers and the offscreen target */
+  state->cubes = 16;
+  setInstanceCount(state->cubes);
+  setOffscreenTarget(state->width, state->height);
+}
+
+static void step_reinit(ScenarioState* state)
+{
+  terminateGL();
+  intializeGL();
+  rotationCube(1, 1);
+}
+
+static void step_recreate(ScenarioState* state)
+{
+  terminateGL();
+  state->failed |= !headless_context_replace(&sContext);
+  intializeGL();
+  rotationCube(1, 1);
+}
+
+static void step_recover(ScenarioState* state)
+{
+  notifyGLContextLost();
+  state->failed |= !headless_context_replace(&sContext);
+  intializeGL();
+  rotationCube(1, 1);
+}
+
+static void step_drag(ScenarioState* state)
+{
+  int i;
+  for (i = 1; i <= 4; i++)
+  {
+    int position = state->frame * 4 + i;
+    updateTouchPosition(position % 400, position % 300);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Statistics and output
+static void summarize(double* samples, int count, Summary* summary)
+{
+  double total = 0.0;
+  int i;
+
+  for (i = 0; i < count; i++)
+  {
+    total += samples[i];
+  }
+  headless_sort_samples(samples, count);
+  summary->mean = total / count;
+  summary->p50 = headless_percentile(samples, count, 50.0);
+  summary->p95 = headless_percentile(samples, count, 95.0);
+  summary->p99 = headless_percentile(samples, count, 99.0);
+  summary->max = samples[count - 1];
+}
+
+static void print_summary(FILE* out, const char* name, const Summary* summary)
+{
+  fprintf(out, "      \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+          name, summary->mean, summary->p50, summary->p95, summary->p99, summary->max);
+}
+
+static void print_json_string(FILE* out, const char* value)
+{
+  fputc('"', out);
+  for (; value && *value; value++)
+  {
+    if (*value == '"' || *value == '\\')
+    {
+      fputc('\\', out);
+    }
+    if ((unsigned char)*value >= 0x20)
+    {
+      fputc(*value, out);
+    }
+  }
+  fputc('"', out);
+}
+
+/*
+ * @ brief Run one scenario from a freshly initialized library state.
+ * @ return 1 on success, 0 when GL reported an error, a capture was not written, GL objects
+ *          outlived terminateGL() or a step failed.
+ */
+static int run_scenario(FILE* out, const Scenario* scenario, int frames, int warmup,
+                        int width, int height, int instances, double* cpuSamples, double* frameSamples, int first)
+{
+  ScenarioState state = { width, height, instances, 0, 1, 0 };
+  Summary cpu, frame;
+  GLStateCounters counters;
+  GLResourceStats initial, resources, released;
+  unsigned int live = 0, leaked = 0;
+  size_t bytes = 0;
+  GLenum error;
+  int i, f, printed;
+  int swapped = 0;
+  int captureFailed;
+
+  updateWindowSize(width, height);
+  updateWindowRotationAngle(0);
+  setInstanceCount(1);
+  setRenderOnDemand(false);
+  setFrustumCulling(true);
+  setOffscreenTarget(0, 0);
+  setCameraProjection(GL_CAMERA_ORTHOGRAPHIC, 0.0f);
+  setCameraController(GL_CAMERA_CONTROL_MODEL);
+  setArcballRotation(false);
+  updateTouchEventState(false);
+  if (scenario->setup)
+  {
+    scenario->setup(&state);
+  }
+  /* Lifetime totals, the difference is this scenario's */
+  getGLResourceStats(&initial);
+  intializeGL();
+
+  for (i = 0; i < warmup; i++, state.frame++)
+  {
+    scenario->step(&state);
+    renderFrameGL();
+  }
+  glFinish();
+
+  call_counter_reset();
+  resetGLStateCounters();
+  for (i = 0; i < frames; i++, state.frame++)
+  {
+    double wallStart = headless_time_now_ms();
+    double cpuStart = headless_thread_cpu_time_ms();
+
+    call_counter_enable(1);
+    scenario->step(&state);
+    swapped += renderFrameGL();
+    call_counter_enable(0);
+
+    cpuSamples[i] = headless_thread_cpu_time_ms() - cpuStart;
+    /* There is no swap, so finish to make the frame sample include the rasterization */
+    glFinish();
+    frameSamples[i] = headless_time_now_ms() - wallStart;
+  }
+  error = glGetError();
+  getGLStateCounters(&counters);
+
+  captureFailed = flushFrameCaptures();
+  getGLResourceStats(&resources);
+  terminateGL();
+  getGLResourceStats(&released);
+  for (f = 0; f < GL_RESOURCE_KIND_COUNT; f++)
+  {
+    live += resources.live[f];
+    bytes += resources.bytes[f];
+    leaked += released.live[f];
+  }
+
+  summarize(cpuSamples, frames, &cpu);
+  summarize(frameSamples, frames, &frame);
+
+  fprintf(out, "%s    {\n", first ? "" : ",\n");
+  fprintf(out, "      \"name\": \"%s\",\n", scenario->name);
+  fprintf(out, "      \"frames\": %d,\n", frames);
+  fprintf(out, "      \"cubes\": %d,\n", state.cubes);
+  fprintf(out, "      \"frames_swapped\": %d,\n", swapped);
+  print_summary(out, "cpu_ms", &cpu);
+  print_summary(out, "frame_ms", &frame);
+  fprintf(out, "      \"gl_calls_per_frame\": %.2f,\n", (double)call_counter_gl_calls() / frames);
+  fprintf(out, "      \"draw_calls_per_frame\": %.2f,\n", (double)counters.drawCalls / frames);
+  fprintf(out, "      \"state_changes_per_frame\": %.2f,\n", (double)counters.issued / frames);
+  fprintf(out, "      \"state_changes_skipped_per_frame\": %.2f,\n", (double)counters.skipped / frames);
+  fprintf(out, "      \"input_events_per_frame\": %.2f,\n", (double)counters.inputEvents / frames);
+  fprintf(out, "      \"visible_cubes_per_frame\": %.2f,\n", (double)counters.visibleObjects / frames);
+  fprintf(out, "      \"stream_stalls\": %u,\n", counters.streamStalls);
+  fprintf(out, "      \"captures_failed\": %d,\n", captureFailed);
+  fprintf(out, "      \"gl_objects_live\": %u,\n", live);
+  fprintf(out, "      \"gl_object_bytes\": %zu,\n", bytes);
+  fprintf(out, "      \"gl_objects_created\": %u,\n", released.created - initial.created);
+  fprintf(out, "      \"gl_objects_reclaimed\": %u,\n", released.reclaimed - initial.reclaimed);
+  fprintf(out, "      \"gl_objects_lost\": %u,\n", released.lost - initial.lost);
+  fprintf(out, "      \"gl_objects_leaked\": %u,\n", leaked);
+  fprintf(out, "      \"snapshot_bytes\": %zu,\n", resources.snapshotBytes);
+  fprintf(out, "      \"allocations_per_frame\": %.2f,\n", (double)call_counter_allocations() / frames);
+  fprintf(out, "      \"allocated_bytes_per_frame\": %.2f,\n", (double)call_counter_allocated_bytes() / frames);
+  fprintf(out, "      \"gl_calls\": {");
+  for (f = 0, printed = 0; f < call_counter_gl_function_count(); f++)
+  {
+    if (call_counter_gl_function_calls(f) > 0)
+    {
+      fprintf(out, "%s \"%s\": %lu", printed++ ? "," : "", call_counter_gl_function_name(f), call_counter_gl_function_calls(f));
+    }
+  }
+  fprintf(out, " },\n");
+  fprintf(out, "      \"gl_error\": %u\n", (unsigned int)error);
+  fprintf(out, "    }");
+
+  return error == GL_NO_ERROR && captureFailed == 0 && leaked == 0 && released.reclaimed == initial.reclaimed && !state.failed;
+}
+
+static void usage(const char* name)
+{
+  int i;
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --scenario NAME   scenario to run, may be repeated (default: all)\n"
+          "  --frames N        measured frames per scenario (default 500)\n"
+          "  --warmup N        warm-up frames per scenario (default 20)\n"
+          "  --width N         surface width (default 1920)\n"
+          "  --height N        surface height (default 1080)\n"
+          "  --gles N          GLES context version, 2 or 3 (default 2)\n"
+          "  --instances N     cubes drawn by the field and orbit scenarios (default 10000)\n"
+          "  --workers N       scene update threads besides the render thread (default: one per\n"
+          "                    additional core, 0 updates on the render thread)\n"
+          "  --output FILE     write the JSON report to FILE instead of stdout\n"
+          "  --list            list the scenarios and exit\n"
+          "Scenarios:\n",
+          name);
+  for (i = 0; i < SCENARIO_COUNT; i++)
+  {
+    fprintf(stderr, "  %-12s %s\n", sScenarios[i].name, sScenarios[i].description);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  static const struct option options[] = {
+    { "scenario", required_argument, NULL, 's' },
+    { "frames",   required_argument, NULL, 'n' },
+    { "warmup",   required_argument, NULL, 'W' },
+    { "width",    required_argument, NULL, 'w' },
+    { "height",   required_argument, NULL, 'h' },
+    { "gles",     required_argument, NULL, 'v' },
+    { "instances", required_argument, NULL, 'i' },
+    { "workers",  required_argument, NULL, 'j' },
+    { "output",   required_argument, NULL, 'o' },
+    { "list",     no_argument,       NULL, 'l' },
+    { "help",     no_argument,       NULL, '?' },
+    { NULL, 0, NULL, 0 }
+  };
+  int selected[SCENARIO_COUNT] = { 0 };
+  int anySelected = 0;
+  int frames = 500;
+  int warmup = 20;
+  int width = 1920;
+  int height = 1080;
+  int version = 2;
+  int instances = 10000;
+  int workers = -1;
+  const char* output = NULL;
+  FILE* out = stdout;
+  double* cpuSamples;
+  double* frameSamples;
+  int opt, i, first = 1, ok = 1;
+
+  while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1)
+  {
+    switch (opt)
+    {
+      case 's':
+        for (i = 0; i < SCENARIO_COUNT; i++)
+        {
+          if (strcmp(optarg, sScenarios[i].name) == 0)
+          {
+            selected[i] = anySelected = 1;
+            break;
+          }
+        }
+        if (i == SCENARIO_COUNT)
+        {
+          fprintf(stderr, "Unknown scenario '%s'\n", optarg);
+          usage(argv[0]);
+          return 2;
+        }
+        break;
+      case 'n': frames = atoi(optarg); break;
+      case 'W': warmup = atoi(optarg); break;
+      case 'w': width = atoi(optarg); break;
+      case 'h': height = atoi(optarg); break;
+      case 'v': version = atoi(optarg); break;
+      case 'i': instances = atoi(optarg); break;
+      case 'j': workers = atoi(optarg); break;
+      case 'o': output = optarg; break;
+      case 'l':
+        for (i = 0; i < SCENARIO_COUNT; i++)
+        {
+          printf("%s\n", sScenarios[i].name);
+        }
+        return 0;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+  if (frames <= 0 || warmup < 0 || width <= 0 || height <= 0 || (version != 2 && version != 3) || instances < 1 || workers < -1)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (!headless_context_create(&sContext, width, height, version))
+  {
+    return 1;
+  }
+  if (!setWorkerThreadCount(workers))
+  {
+    fprintf(stderr, "Invalid worker thread count %d\n", workers);
+    headless_context_destroy(&sContext);
+    return 1;
+  }
+
+  if (output && !(out = fopen(output, "w")))
+  {
+    perror(output);
+    headless_context_destroy(&sContext);
+    return 1;
+  }
+
+  cpuSamples = (double*)malloc(sizeof(double) * frames);
+  frameSamples = (double*)malloc(sizeof(double) * frames);
+  if (!cpuSamples || !frameSamples)
+  {
+    free(cpuSamples);
+    free(frameSamples);
+    headless_context_destroy(&sContext);
+    return 1;
+  }
+
+  fprintf(out, "{\n");
+  fprintf(out, "  \"schema\": %d,\n", BENCHMARK_SCHEMA);
+  fprintf(out, "  \"renderer\": ");
+  print_json_string(out, (const char*)glGetString(GL_RENDERER));
+  fprintf(out, ",\n  \"gl_version\": ");
+  print_json_string(out, (const char*)glGetString(GL_VERSION));
+  fprintf(out, ",\n  \"width\": %d,\n  \"height\": %d,\n  \"warmup\": %d,\n", width, height, warmup);
+  fprintf(out, "  \"workers\": %d,\n", workers);
+  fprintf(out, "  \"scenarios\": [\n");
+
+  for (i = 0; i < SCENARIO_COUNT; i++)
+  {
+    if (anySelected && !selected[i])
+    {
+      continue;
+    }
+    ok &= run_scenario(out, &sScenarios[i], frames, warmup, width, height, instances, cpuSamples, frameSamples, first);
+    first = 0;
+  }
+
+  fprintf(out, "\n  ]\n}\n");
+
+  if (out != stdout)
+  {
+    fclose(out);
+  }
+  free(cpuSamples);
+  free(frameSamples);
+  headless_context_destroy(&sContext);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Golden image check for dali-nativegl-library.
+ *
+ * Renders the cube at fixed angles, window orientations and sizes in a headless EGL context
+ * (Mesa llvmpipe gives the same pixels on every machine) and compares every frame against a
+ * reference PPM under tools/golden. Frames may differ where a human would not notice: colors
+ * within a perceptual threshold, and edges moved by a pixel. The render time of every case is
+ * reported next to the result, so a renderer change shows both what it costs and what it draws.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <GLES2/gl2.h>
+
+#include <dali-nativegl-library.h>
+
+#include "headless-util.h"
+
+#ifndef GOLDEN_REFERENCE_DIR
+#define GOLDEN_REFERENCE_DIR "tools/golden"
+#endif
+
+/* Large enough for every case, frames are drawn and read from the lower left corner */
+#define GOLDEN_SURFACE_SIZE 96
+
+/* Largest YIQ distance, between black and white */
+#define GOLDEN_MAX_DELTA 35215.0
+
+typedef struct {
+    const char* name;
+    int width;           /* Window size as the application sees it */
+    int height;
+    int orientation;     /* updateWindowRotationAngle(), 90 and 270 draw width x height rotated */
+    int rotateX;         /* rotationCube() before the frame */
+    int rotateY;
+    int instances;
+    GLCameraProjection projection;
+    float fovY;
+    GLCameraController controller;
+    int dragX;           /* Touch drag from the window center before the frame, moves the camera with */
+    int dragY;           /* controller or the cube */
+    bool arcball;
+} GoldenCase;
+
+typedef struct {
+    int width;
+    int height;
+    unsigned char* rgb;  /* Top row first */
+} Image;
+
+static const GoldenCase sCases[] = {
+  { "landscape",       80, 48,   0,   0,   0, 1 },
+  { "portrait",        48, 80,   0,   0,   0, 1 },
+  { "square",          64, 64,   0,   0,   0, 1 },
+  { "orientation-90",  48, 80,  90,   0,   0, 1 },
+  { "orientation-180", 80, 48, 180,   0,   0, 1 },
+  { "orientation-270", 48, 80, 270,   0,   0, 1 },
+  { "angle",           80, 48,   0,  60, -30, 1 },
+  { "angle-90",        48, 80,  90,  60, -30, 1 },
+  { "angle-back",      64, 64,   0, 180,  90, 1 },
+  { "field",           80, 48,   0,  20,  20, 16 },
+  { "perspective",     80, 48,   0,  60, -30, 1, GL_CAMERA_PERSPECTIVE, 0.0f },
+  { "perspective-90",  48, 80,  90,  60, -30, 1, GL_CAMERA_PERSPECTIVE, 0.0f },
+  { "perspective-fov", 64, 64,   0,  20,  20, 1, GL_CAMERA_PERSPECTIVE, 30.0f },
+  { "orbit",           80, 48,   0,  20,  20, 16, GL_CAMERA_PERSPECTIVE, 0.0f, GL_CAMERA_CONTROL_ORBIT, 40, 30 },
+  { "pan",             80, 48,   0,  60, -30, 1, GL_CAMERA_ORTHOGRAPHIC, 0.0f, GL_CAMERA_CONTROL_PAN, 20, -10 },
+  { "zoom",            64, 64,   0,  60, -30, 1, GL_CAMERA_PERSPECTIVE, 0.0f, GL_CAMERA_CONTROL_ZOOM, 0, -50 },
+  { "drag",            64, 64,   0,   0,   0, 1, GL_CAMERA_ORTHOGRAPHIC, 0.0f, GL_CAMERA_CONTROL_MODEL, 20, 10 },
+  { "arcball",         64, 64,   0,   0,   0, 1, GL_CAMERA_ORTHOGRAPHIC, 0.0f, GL_CAMERA_CONTROL_MODEL, 20, 10, true },
+};
+
+#define CASE_COUNT ((int)(sizeof(sCases) / sizeof(sCases[0])))
+
+static int render_case(const GoldenCase* golden, int frames, double* samples, Image* image);
+static int read_ppm(const char* path, Image* image);
+static int write_ppm(const char* path, const Image* image);
+static double pixel_delta(const unsigned char* a, const unsigned char* b);
+static int near_match(const Image* image, const Image* other, int x, int y, double limit);
+static int compare(const Image* image, const Image* reference, double threshold, double* worst);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Rendering
+/*
+ * @ brief Draw a case from a freshly initialized library state and read the frame back.
+ * @ param[out] samples Wall time of each of frames renderFrameGL() calls including glFinish().
+ * @ return 1 on success, 0 on a GL error or when out of memory.
+ */
+static int render_case(const GoldenCase* golden, int frames, double* samples, Image* image)
+{
+  int rotated = golden->orientation == 90 || golden->orientation == 270;
+  int width = rotated ? golden->height : golden->width;
+  int height = rotated ? golden->width : golden->height;
+  unsigned char* rgba;
+  int i, y;
+  GLenum error;
+
+  updateWindowSize(golden->width, golden->height);
+  updateWindowRotationAngle(golden->orientation);
+  setInstanceCount(golden->instances);
+  setRenderOnDemand(false);
+  setCameraProjection(golden->projection, golden->fovY);
+  setCameraController(golden->controller);
+  setArcballRotation(golden->arcball);
+  intializeGL();
+  rotationCube(golden->rotateX, golden->rotateY);
+  if (golden->dragX != 0 || golden->dragY != 0)
+  {
+    /* A motion without touch only places the finger */
+    updateTouchPosition(golden->width / 2, golden->height / 2);
+    updateTouchEventState(true);
+    updateTouchPosition(golden->width / 2 + golden->dragX, golden->height / 2 + golden->dragY);
+    updateTouchEventState(false);
+  }
+
+  /* The first frame applies the rotation, the others draw the same picture again */
+  for (i = 0; i < frames; i++)
+  {
+    double start = headless_time_now_ms();
+    renderFrameGL();
+    glFinish();
+    samples[i] = headless_time_now_ms() - start;
+  }
+
+  image->width = width;
+  image->height = height;
+  image->rgb = (unsigned char*)malloc(width * height * 3);
+  rgba = (unsigned char*)malloc(width * height * 4);
+  if (rgba && image->rgb)
+  {
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    for (y = 0; y < height; y++)
+    {
+      const unsigned char* src = rgba + (height - 1 - y) * width * 4;
+      unsigned char* dst = image->rgb + y * width * 3;
+      for (i = 0; i < width; i++)
+      {
+        dst[i * 3] = src[i * 4];
+        dst[i * 3 + 1] = src[i * 4 + 1];
+        dst[i * 3 + 2] = src[i * 4 + 2];
+      }
+    }
+  }
+  error = glGetError();
+  terminateGL();
+  free(rgba);
+
+  if (error != GL_NO_ERROR)
+  {
+    fprintf(stderr, "%s: GL error 0x%x\n", golden->name, error);
+  }
+  return rgba && image->rgb && error == GL_NO_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Images
+/*
+ * @ brief Read a binary PPM (P6, maxval 255).
+ * @ return 1 on success, 0 when missing or malformed.
+ */
+static int read_ppm(const char* path, Image* image)
+{
+  FILE* file = fopen(path, "rb");
+  int maxval;
+  size_t size;
+
+  image->rgb = NULL;
+  if (!file)
+  {
+    return 0;
+  }
+  if (fscanf(file, "P6 %d %d %d", &image->width, &image->height, &maxval) != 3 || maxval != 255 ||
+      image->width <= 0 || image->height <= 0 || fgetc(file) == EOF)
+  {
+    fclose(file);
+    return 0;
+  }
+  size = (size_t)image->width * image->height * 3;
+  image->rgb = (unsigned char*)malloc(size);
+  if (!image->rgb || fread(image->rgb, 1, size, file) != size)
+  {
+    free(image->rgb);
+    image->rgb = NULL;
+    fclose(file);
+    return 0;
+  }
+  fclose(file);
+  return 1;
+}
+
+static int write_ppm(const char* path, const Image* image)
+{
+  FILE* file = fopen(path, "wb");
+  size_t size = (size_t)image->width * image->height * 3;
+  int ok;
+
+  if (!file)
+  {
+    perror(path);
+    return 0;
+  }
+  fprintf(file, "P6\n%d %d\n255\n", image->width, image->height);
+  ok = fwrite(image->rgb, 1, size, file) == size;
+  return (fclose(file) == 0) && ok;
+}
+
+/*
+ * @ brief Squared YIQ distance of two RGB pixels; luma weighs most, as for the eye.
+ */
+static double pixel_delta(const unsigned char* a, const unsigned char* b)
+{
+  double r = (double)a[0] - b[0];
+  double g = (double)a[1] - b[1];
+  double bl = (double)a[2] - b[2];
+  double y = r * 0.29889531 + g * 0.58662247 + bl * 0.11448223;
+  double i = r * 0.59597799 - g * 0.27417610 - bl * 0.32180189;
+  double q = r * 0.21147017 - g * 0.52261711 + bl * 0.31114694;
+
+  return 0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q;
+}
+
+/*
+ * @ brief Whether the pixel of image matches other at the same place or one pixel away, so an
+ *         edge rasterized a pixel off does not count.
+ */
+static int near_match(const Image* image, const Image* other, int x, int y, double limit)
+{
+  const unsigned char* pixel = image->rgb + (y * image->width + x) * 3;
+  int dx, dy;
+
+  for (dy = -1; dy <= 1; dy++)
+  {
+    for (dx = -1; dx <= 1; dx++)
+    {
+      int rx = x + dx;
+      int ry = y + dy;
+      if (rx >= 0 && ry >= 0 && rx < other->width && ry < other->height &&
+          pixel_delta(pixel, other->rgb + (ry * other->width + rx) * 3) <= limit)
+      {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/*
+ * @ brief Count the pixels that differ visibly from the reference.
+ * @ param[in]  threshold Largest unnoticed color difference, 0 to 1 of black against white.
+ * @ param[out] worst     Largest difference at the same place, in the same unit.
+ * @ return The number of differing pixels, or -1 when the sizes differ.
+ */
+static int compare(const Image* image, const Image* reference, double threshold, double* worst)
+{
+  const double limit = GOLDEN_MAX_DELTA * threshold * threshold;
+  double largest = 0.0;
+  int differing = 0;
+  int x, y;
+
+  *worst = 1.0;
+  if (image->width != reference->width || image->height != reference->height)
+  {
+    return -1;
+  }
+  for (y = 0; y < image->height; y++)
+  {
+    for (x = 0; x < image->width; x++)
+    {
+      int offset = (y * image->width + x) * 3;
+      double delta = pixel_delta(image->rgb + offset, reference->rgb + offset);
+      if (delta > largest)
+      {
+        largest = delta;
+      }
+      /* Both ways, or a detail missing from one image would match its surroundings */
+      if (delta > limit &&
+          (!near_match(image, reference, x, y, limit) || !near_match(reference, image, x, y, limit)))
+      {
+        differing++;
+      }
+    }
+  }
+  *worst = sqrt(largest / GOLDEN_MAX_DELTA);
+  return differing;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void usage(const char* name)
+{
+  int i;
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --case NAME        case to run, may be repeated (default: all)\n"
+          "  --references DIR   reference images (default " GOLDEN_REFERENCE_DIR ")\n"
+          "  --update           write the rendered frames as the new references\n"
+          "  --diff DIR         write the frames of failing cases to DIR\n"
+          "  --threshold T      largest unnoticed color difference, 0 to 1 (default 0.1)\n"
+          "  --tolerance N      differing pixels allowed per case (default 0)\n"
+          "  --frames N         timed frames per case (default 10)\n"
+          "  --gles N           GLES context version, 2 or 3 (default 2)\n"
+          "  --list             list the cases and exit\n"
+          "Cases:\n",
+          name);
+  for (i = 0; i < CASE_COUNT; i++)
+  {
+    fprintf(stderr, "  %-16s %dx%d, orientation %d, rotation %d,%d, %d cube(s)%s, drag %d,%d%s\n", sCases[i].name,
+            sCases[i].width, sCases[i].height, sCases[i].orientation, sCases[i].rotateX, sCases[i].rotateY,
+            sCases[i].instances, sCases[i].projection == GL_CAMERA_PERSPECTIVE ? ", perspective" : "",
+            sCases[i].dragX, sCases[i].dragY, sCases[i].arcball ? " on the arcball" : "");
+  }
+}
+
+int main(int argc, char** argv)
+{
+  static const struct option options[] = {
+    { "case",       required_argument, NULL, 'c' },
+    { "references", required_argument, NULL, 'r' },
+    { "update",     no_argument,       NULL, 'u' },
+    { "diff",       required_argument, NULL, 'd' },
+    { "threshold",  required_argument, NULL, 't' },
+    { "tolerance",  required_argument, NULL, 'T' },
+    { "frames",     required_argument, NULL, 'n' },
+    { "gles",       required_argument, NULL, 'v' },
+    { "list",       no_argument,       NULL, 'l' },
+    { "help",       no_argument,       NULL, '?' },
+    { NULL, 0, NULL, 0 }
+  };
+  int selected[CASE_COUNT] = { 0 };
+  int anySelected = 0;
+  const char* references = GOLDEN_REFERENCE_DIR;
+  const char* diff = NULL;
+  int update = 0;
+  double threshold = 0.1;
+  int tolerance = 0;
+  int frames = 10;
+  int version = 2;
+  HeadlessContext ctx;
+  double* samples;
+  int opt, i, failed = 0;
+
+  while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1)
+  {
+    switch (opt)
+    {
+      case 'c':
+        for (i = 0; i < CASE_COUNT; i++)
+        {
+          if (strcmp(optarg, sCases[i].name) == 0)
+          {
+            selected[i] = anySelected = 1;
+            break;
+          }
+        }
+        if (i == CASE_COUNT)
+        {
+          fprintf(stderr, "Unknown case '%s'\n", optarg);
+          usage(argv[0]);
+          return 2;
+        }
+        break;
+      case 'r': references = optarg; break;
+      case 'u': update = 1; break;
+      case 'd': diff = optarg; break;
+      case 't': threshold = atof(optarg); break;
+      case 'T': tolerance = atoi(optarg); break;
+      case 'n': frames = atoi(optarg); break;
+      case 'v': version = atoi(optarg); break;
+      case 'l':
+        for (i = 0; i < CASE_COUNT; i++)
+        {
+          printf("%s\n", sCases[i].name);
+        }
+        return 0;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+  if (frames <= 0 || threshold < 0.0 || threshold > 1.0 || tolerance < 0 || (version != 2 && version != 3))
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (!headless_context_create(&ctx, GOLDEN_SURFACE_SIZE, GOLDEN_SURFACE_SIZE, version))
+  {
+    return 1;
+  }
+  samples = (double*)malloc(sizeof(double) * frames);
+  if (!samples)
+  {
+    headless_context_destroy(&ctx);
+    return 1;
+  }
+
+  printf("renderer : %s\n", (const char*)glGetString(GL_RENDERER));
+  printf("version  : %s\n", (const char*)glGetString(GL_VERSION));
+  printf("%-16s %-8s %9s %8s %10s %10s\n", "case", "result", "differing", "worst", "first ms", "p50 ms");
+
+  for (i = 0; i < CASE_COUNT; i++)
+  {
+    char path[4096];
+    Image image = { 0, 0, NULL };
+    Image reference = { 0, 0, NULL };
+    const char* result;
+    int differing = 0;
+    double worst = 0.0;
+    double first;
+
+    if (anySelected && !selected[i])
+    {
+      continue;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s.ppm", references, sCases[i].name);
+    if (!render_case(&sCases[i], frames, samples, &image))
+    {
+      result = "error";
+    }
+    else if (update)
+    {
+      result = write_ppm(path, &image) ? "updated" : "error";
+    }
+    else if (!read_ppm(path, &reference))
+    {
+      result = "missing";
+    }
+    else
+    {
+      differing = compare(&image, &reference, threshold, &worst);
+      result = differing >= 0 && differing <= tolerance ? "ok" : "FAIL";
+    }
+
+    /* The first frame includes the uploads and shader setup of the new initialization */
+    first = samples[0];
+    headless_sort_samples(samples, frames);
+    printf("%-16s %-8s %9d %8.3f %10.3f %10.3f\n", sCases[i].name, result, differing, worst, first,
+           headless_percentile(samples, frames, 50.0));
+
+    if (strcmp(result, "ok") != 0 && strcmp(result, "updated") != 0)
+    {
+      failed++;
+      if (diff && image.rgb)
+      {
+        snprintf(path, sizeof(path), "%s/%s.ppm", diff, sCases[i].name);
+        write_ppm(path, &image);
+      }
+    }
+    free(image.rgb);
+    free(reference.rgb);
+  }
+
+  free(samples);
+  headless_context_destroy(&ctx);
+  if (failed)
+  {
+    fprintf(stderr, "%d case(s) failed\n", failed);
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Headless driver for dali-nativegl-library.
+ *
+ * Creates an offscreen EGL context (Mesa surfaceless/pbuffer, works on llvmpipe with
+ * LIBGL_ALWAYS_SOFTWARE=1) and calls the same entry points the DALi/NUI GlWindow calls:
+ * intializeGL() once, renderFrameGL() per frame and terminateGL() at the end.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <GLES2/gl2.h>
+
+#include <dali-nativegl-library.h>
+
+#include "headless-util.h"
+
+static void usage(const char* name)
+{
+  fprintf(stderr,
+          "Usage: %s [-n frames] [-w width] [-h height] [-W warmup] [-v gles-version] [-m mesh] [-c cache-dir] [-t trace.json] [-p] [-o frame.png]\n"
+          "  -n  measured frames (default 300)\n"
+          "  -w  surface width (default 1920)\n"
+          "  -h  surface height (default 1080)\n"
+          "  -W  warm-up frames excluded from the statistics (default 10)\n"
+          "  -v  GLES context version, 2 or 3 (default 2)\n"
+          "  -m  binary mesh file drawn instead of the cube\n"
+          "  -c  program binary cache directory (GLES3)\n"
+          "  -t  write a Chrome trace at exit (library built with ENABLE_TRACING)\n"
+          "  -p  print the library's CPU and GPU (GL_EXT_disjoint_timer_query) pass timings\n"
+          "  -o  write one more frame to a file, PNG when the name ends in .png, raw RGBA otherwise\n",
+          name);
+}
+
+int main(int argc, char** argv)
+{
+  HeadlessContext ctx;
+  int frames = 300;
+  int width = 1920;
+  int height = 1080;
+  int warmup = 10;
+  int version = 2;
+  const char* mesh = NULL;
+  const char* cache = NULL;
+  const char* trace = NULL;
+  const char* output = NULL;
+  int passTiming = 0;
+  int opt, i;
+  int captureFailed = 0;
+  double* samples;
+  double total = 0.0;
+  double start;
+  GLenum error;
+
+  while ((opt = getopt(argc, argv, "n:w:h:W:v:m:c:t:po:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n': frames = atoi(optarg); break;
+      case 'w': width = atoi(optarg); break;
+      case 'h': height = atoi(optarg); break;
+      case 'W': warmup = atoi(optarg); break;
+      case 'v': version = atoi(optarg); break;
+      case 'm': mesh = optarg; break;
+      case 'c': cache = optarg; break;
+      case 't': trace = optarg; break;
+      case 'p': passTiming = 1; break;
+      case 'o': output = optarg; break;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+  if (frames <= 0 || width <= 0 || height <= 0 || warmup < 0 || (version != 2 && version != 3))
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (!headless_context_create(&ctx, width, height, version))
+  {
+    return 1;
+  }
+
+  samples = (double*)malloc(sizeof(double) * frames);
+  if (!samples)
+  {
+    headless_context_destroy(&ctx);
+    return 1;
+  }
+
+  /* Same order as the GlWindow: size is known before the init callback runs */
+  updateWindowSize(width, height);
+  if ((mesh && !setMeshFile(mesh)) || (cache && !setProgramCacheDirectory(cache)))
+  {
+    free(samples);
+    headless_context_destroy(&ctx);
+    return 1;
+  }
+  setFrameTimingEnabled(passTiming);
+  start = headless_time_now_ms();
+  intializeGL();
+  glFinish();
+  printf("renderer       : %s\n", (const char*)glGetString(GL_RENDERER));
+  printf("version        : %s\n", (const char*)glGetString(GL_VERSION));
+  printf("surface        : %dx%d\n", width, height);
+  printf("init           : %.3f ms\n", headless_time_now_ms() - start);
+
+  for (i = 0; i < warmup; i++)
+  {
+    renderFrameGL();
+  }
+  glFinish();
+
+  for (i = 0; i < frames; i++)
+  {
+    start = headless_time_now_ms();
+    renderFrameGL();
+    /* There is no swap, so wait for the GPU to make the sample cover the whole frame */
+    glFinish();
+    samples[i] = headless_time_now_ms() - start;
+    total += samples[i];
+  }
+
+  /* Outside the measured frames, the capture adds a readback and a file write */
+  if (output)
+  {
+    size_t length = strlen(output);
+    GLCaptureFormat format = length > 4 && strcmp(output + length - 4, ".png") == 0 ? GL_CAPTURE_PNG : GL_CAPTURE_RAW;
+
+    if (requestFrameCapture(output, format))
+    {
+      renderFrameGL();
+      captureFailed = flushFrameCaptures();
+    }
+    else
+    {
+      captureFailed = 1;
+    }
+  }
+
+  error = glGetError();
+  if (passTiming)
+  {
+    static const char* names[GL_TIMING_PASS_COUNT] = { "cpu input", "cpu render", "gpu render" };
+    GLTimingStats stats;
+
+    for (i = 0; i < GL_TIMING_PASS_COUNT; i++)
+    {
+      if (getFrameTimingStats((GLTimingPass)i, &stats))
+      {
+        printf("%-15s: p50 %.3f ms, p95 %.3f ms, max %.3f ms (%u frames)\n", names[i], stats.p50, stats.p95, stats.max, stats.samples);
+      }
+      else
+      {
+        printf("%-15s: not measured\n", names[i]);
+      }
+    }
+  }
+  terminateGL();
+
+  headless_sort_samples(samples, frames);
+  printf("frames         : %d\n", frames);
+  printf("mean           : %.3f ms\n", total / frames);
+  printf("min            : %.3f ms\n", samples[0]);
+  printf("p50            : %.3f ms\n", headless_percentile(samples, frames, 50.0));
+  printf("p95            : %.3f ms\n", headless_percentile(samples, frames, 95.0));
+  printf("p99            : %.3f ms\n", headless_percentile(samples, frames, 99.0));
+  printf("max            : %.3f ms\n", samples[frames - 1]);
+
+  if (trace && !dumpTrace(trace))
+  {
+    fprintf(stderr, "cannot write trace %s, is tracing compiled in?\n", trace);
+  }
+
+  free(samples);
+  headless_context_destroy(&ctx);
+  if (captureFailed)
+  {
+    fprintf(stderr, "cannot write frame %s\n", output);
+    return 1;
+  }
+  if (error != GL_NO_ERROR)
+  {
+    fprintf(stderr, "GL error 0x%x while rendering\n", error);
+    return 1;
+  }
+  return 0;
+}
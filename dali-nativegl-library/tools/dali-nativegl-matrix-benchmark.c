@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Micro-benchmark of the matrix module against the scalar multiply_matrix()/rotate_xyz()
+ * it replaced. The reference functions are kept here unchanged; results are also compared
+ * so a speedup never comes from a wrong answer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#include <dali-nativegl-matrix_private.h>
+
+#define MAX_ERROR 1e-4f
+
+/* Working set of matrices, small enough to stay in cache so the arithmetic is measured, not memory */
+#define SET_SIZE 1024
+#define SET(i) ((i) & (SET_SIZE - 1))
+
+static volatile float sSink;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reference implementation
+static void init_matrix(float matrix[16])
+{
+  int i;
+  for (i = 0; i < 16; i++)
+  {
+    matrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+  }
+}
+
+static void multiply_matrix(float matrix[16], const float matrix0[16], const float matrix1[16])
+{
+  int i;
+  int row;
+  int column;
+  float temp[16];
+
+  for (column = 0; column < 4; column++)
+  {
+    for (row = 0; row < 4; row++)
+    {
+      temp[column * 4 + row] = 0.0f;
+      for (i = 0; i < 4; i++)
+      {
+        temp[column * 4 + row] += matrix0[i * 4 + row] * matrix1[column * 4 + i];
+      }
+    }
+  }
+
+  for (i = 0; i < 16; i++)
+  {
+    matrix[i] = temp[i];
+  }
+}
+
+static void rotate_xyz(float matrix[16], const float anglex, const float angley, const float anglez)
+{
+  const float pi = 3.141592f;
+  float temp[16];
+  float rz = 2.0f * pi * anglez / 360.0f;
+  float rx = 2.0f * pi * anglex / 360.0f;
+  float ry = 2.0f * pi * angley / 360.0f;
+
+  float sy = sinf(ry);
+  float cy = cosf(ry);
+  float sx = sinf(rx);
+  float cx = cosf(rx);
+  float sz = sinf(rz);
+  float cz = cosf(rz);
+  init_matrix(temp);
+
+  temp[0] = cy * cz - sx * sy * sz;
+  temp[1] = cz * sx * sy + cy * sz;
+  temp[2] = -cx * sy;
+
+  temp[4] = -cx * sz;
+  temp[5] = cx * cz;
+  temp[6] = sx;
+
+  temp[8] = cz * sy + cy * sx * sz;
+  temp[9] = -cy * cz * sx + sy * sz;
+  temp[10] = cx * cy;
+
+  multiply_matrix(matrix, matrix, temp);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static float max_error(const float* a, const float* b, int count)
+{
+  float error = 0.0f;
+  int i;
+  for (i = 0; i < count; i++)
+  {
+    float d = fabsf(a[i] - b[i]);
+    if (d > error)
+    {
+      error = d;
+    }
+  }
+  return error;
+}
+
+static void fill_random(float* values, int count)
+{
+  int i;
+  for (i = 0; i < count; i++)
+  {
+    values[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+  }
+}
+
+static void print_result(const char* name, int count, double referenceNs, double optimizedNs, float error, int first)
+{
+  printf("%s    { \"name\": \"%s\", \"operations\": %d, \"reference_ns\": %.2f, \"optimized_ns\": %.2f, "
+         "\"speedup\": %.2f, \"max_error\": %g }",
+         first ? "" : ",\n", name, count, referenceNs / count, optimizedNs / count, referenceNs / optimizedNs, error);
+}
+
+int main(int argc, char** argv)
+{
+  int count = 100000;
+  int opt, i, j;
+  float* a;
+  float* b;
+  float* reference;
+  float* optimized;
+  float* points;
+  float matrix[16];
+  double start, referenceNs, optimizedNs;
+  float error, worst = 0.0f;
+
+  while ((opt = getopt(argc, argv, "n:")) != -1)
+  {
+    if (opt == 'n')
+    {
+      count = atoi(optarg);
+    }
+    else
+    {
+      fprintf(stderr, "Usage: %s [-n operations]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (count <= 0)
+  {
+    return 2;
+  }
+
+  a = (float*)malloc(sizeof(float) * 16 * SET_SIZE);
+  b = (float*)malloc(sizeof(float) * 16 * SET_SIZE);
+  reference = (float*)malloc(sizeof(float) * 16 * SET_SIZE);
+  optimized = (float*)malloc(sizeof(float) * 16 * SET_SIZE);
+  points = (float*)malloc(sizeof(float) * 4 * SET_SIZE);
+  if (!a || !b || !reference || !optimized || !points)
+  {
+    return 1;
+  }
+  srand(1);
+  fill_random(a, 16 * SET_SIZE);
+  fill_random(b, 16 * SET_SIZE);
+  fill_random(points, 4 * SET_SIZE);
+  fill_random(matrix, 16);
+
+  printf("{\n  \"simd\": \"%s\",\n  \"results\": [\n", matrix_simd_name());
+
+  /* Single multiply, one matrix pair per call */
+  start = now_ns();
+  for (i = 0; i < count; i++)
+  {
+    multiply_matrix(reference + SET(i) * 16, a + SET(i) * 16, b + SET(i) * 16);
+  }
+  referenceNs = now_ns() - start;
+  start = now_ns();
+  for (i = 0; i < count; i++)
+  {
+    matrix_multiply(optimized + SET(i) * 16, a + SET(i) * 16, b + SET(i) * 16);
+  }
+  optimizedNs = now_ns() - start;
+  error = max_error(reference, optimized, 16 * SET_SIZE);
+  worst = error > worst ? error : worst;
+  print_result("multiply", count, referenceNs, optimizedNs, error, 1);
+
+  /* One matrix times N matrices, as for per-object MVPs */
+  start = now_ns();
+  for (i = 0; i < count; i++)
+  {
+    multiply_matrix(reference + SET(i) * 16, matrix, b + SET(i) * 16);
+  }
+  referenceNs = now_ns() - start;
+  start = now_ns();
+  for (i = 0; i < count; i += SET_SIZE)
+  {
+    matrix_multiply_batch(optimized, matrix, b, count - i < SET_SIZE ? count - i : SET_SIZE);
+  }
+  optimizedNs = now_ns() - start;
+  error = max_error(reference, optimized, 16 * SET_SIZE);
+  worst = error > worst ? error : worst;
+  print_result("multiply_batch", count, referenceNs, optimizedNs, error, 0);
+
+  /* Rotation applied to an existing matrix, as for the camera's view */
+  start = now_ns();
+  for (i = 0; i < count; i++)
+  {
+    float* m = reference + SET(i) * 16;
+    memcpy(m, a + SET(i) * 16, sizeof(float) * 16);
+    rotate_xyz(m, a[SET(i)] * 360.0f, b[SET(i)] * 360.0f, 90.0f);
+  }
+  referenceNs = now_ns() - start;
+  start = now_ns();
+  for (i = 0; i < count; i++)
+  {
+    float* m = optimized + SET(i) * 16;
+    memcpy(m, a + SET(i) * 16, sizeof(float) * 16);
+    matrix_rotate_xyz(m, a[SET(i)] * 360.0f, b[SET(i)] * 360.0f, 90.0f);
+  }
+  optimizedNs = now_ns() - start;
+  error = max_error(reference, optimized, 16 * SET_SIZE);
+  worst = error > worst ? error : worst;
+  print_result("rotate_xyz", count, referenceNs, optimizedNs, error, 0);
+
+  /* Transform N points, previously a full matrix multiply with a translation matrix each */
+  start = now_ns();
+  for (i = 0; i < count; i++)
+  {
+    float translation[16];
+    init_matrix(translation);
+    for (j = 0; j < 3; j++)
+    {
+      translation[12 + j] = points[SET(i) * 4 + j];
+    }
+    multiply_matrix(translation, matrix, translation);
+    for (j = 0; j < 4; j++)
+    {
+      reference[SET(i) * 4 + j] = translation[12 + j];
+    }
+  }
+  referenceNs = now_ns() - start;
+  start = now_ns();
+  for (i = 0; i < count; i += SET_SIZE)
+  {
+    matrix_transform_points(optimized, 4, matrix, points, 4, count - i < SET_SIZE ? count - i : SET_SIZE);
+  }
+  optimizedNs = now_ns() - start;
+  error = max_error(reference, optimized, 4 * SET_SIZE);
+  worst = error > worst ? error : worst;
+  print_result("transform_points", count, referenceNs, optimizedNs, error, 0);
+
+  printf("\n  ]\n}\n");
+
+  sSink = reference[SET_SIZE - 1] + optimized[SET_SIZE - 1];
+  free(a);
+  free(b);
+  free(reference);
+  free(optimized);
+  free(points);
+
+  if (worst > MAX_ERROR)
+  {
+    fprintf(stderr, "matrix results differ from the reference by %g\n", worst);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,581 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Offline converter from OBJ or PLY to the binary mesh file loaded by setMeshFile().
+ *
+ * Polygons are triangulated as fans, vertex colors are taken from PLY red/green/blue properties
+ * or the "v x y z r g b" OBJ extension, other attributes are ignored. The result is
+ * deduplicated and packed exactly as the library uploads it, so loading is a plain mmap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <float.h>
+#include <getopt.h>
+
+#include <dali-nativegl-mesh_private.h>
+
+#define DEFAULT_COLOR 0.8f
+#define MAX_PLY_PROPERTIES 32
+
+/* Growable float array */
+typedef struct {
+  float* data;
+  size_t count;
+  size_t capacity;
+} FloatArray;
+
+/* Source mesh before expansion: positions + colors per vertex, triangles as index triples */
+typedef struct {
+  FloatArray vertices;   /* x, y, z, r, g, b */
+  int* triangles;
+  size_t triangleCount;
+  size_t triangleCapacity;
+} SourceMesh;
+
+typedef enum {
+  PLY_NONE, PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64
+} PlyType;
+
+typedef struct {
+  char name[64];
+  PlyType type;
+  PlyType countType;     /* PLY_NONE unless the property is a list */
+} PlyProperty;
+
+typedef struct {
+  char name[64];
+  long count;
+  PlyProperty properties[MAX_PLY_PROPERTIES];
+  int propertyCount;
+} PlyElement;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+static int float_array_push(FloatArray* array, const float* values, size_t count)
+{
+  if (array->count + count > array->capacity)
+  {
+    size_t capacity = array->capacity ? array->capacity * 2 : 1024;
+    float* data;
+    while (capacity < array->count + count)
+    {
+      capacity *= 2;
+    }
+    data = (float*)realloc(array->data, sizeof(float) * capacity);
+    if (!data)
+    {
+      return 0;
+    }
+    array->data = data;
+    array->capacity = capacity;
+  }
+  memcpy(array->data + array->count, values, sizeof(float) * count);
+  array->count += count;
+  return 1;
+}
+
+static int push_triangle(SourceMesh* source, int a, int b, int c)
+{
+  if (source->triangleCount == source->triangleCapacity)
+  {
+    size_t capacity = source->triangleCapacity ? source->triangleCapacity * 2 : 1024;
+    int* triangles = (int*)realloc(source->triangles, sizeof(int) * 3 * capacity);
+    if (!triangles)
+    {
+      return 0;
+    }
+    source->triangles = triangles;
+    source->triangleCapacity = capacity;
+  }
+  source->triangles[source->triangleCount * 3] = a;
+  source->triangles[source->triangleCount * 3 + 1] = b;
+  source->triangles[source->triangleCount * 3 + 2] = c;
+  source->triangleCount++;
+  return 1;
+}
+
+/*
+ * @ brief Add the polygon as a triangle fan, indices are checked against the vertex count.
+ */
+static int push_polygon(SourceMesh* source, const int* polygon, int count)
+{
+  int vertexCount = (int)(source->vertices.count / 6);
+  int i;
+
+  for (i = 0; i < count; i++)
+  {
+    if (polygon[i] < 0 || polygon[i] >= vertexCount)
+    {
+      fprintf(stderr, "face index %d out of range\n", polygon[i]);
+      return 0;
+    }
+  }
+  for (i = 2; i < count; i++)
+  {
+    if (!push_triangle(source, polygon[0], polygon[i - 1], polygon[i]))
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static const char* file_extension(const char* path)
+{
+  const char* dot = strrchr(path, '.');
+  return dot ? dot + 1 : "";
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OBJ
+static int load_obj(FILE* file, SourceMesh* source)
+{
+  char line[4096];
+  int* polygon = NULL;
+  int polygonCapacity = 0;
+  int ok = 1;
+
+  while (ok && fgets(line, sizeof(line), file))
+  {
+    if (line[0] == 'v' && (line[1] == ' ' || line[1] == '\t'))
+    {
+      float vertex[6] = { 0.0f, 0.0f, 0.0f, DEFAULT_COLOR, DEFAULT_COLOR, DEFAULT_COLOR };
+      int count = sscanf(line + 2, "%f %f %f %f %f %f", &vertex[0], &vertex[1], &vertex[2],
+                         &vertex[3], &vertex[4], &vertex[5]);
+      if (count < 3)
+      {
+        fprintf(stderr, "bad vertex: %s", line);
+        ok = 0;
+      }
+      else
+      {
+        if (count < 6)
+        {
+          vertex[3] = vertex[4] = vertex[5] = DEFAULT_COLOR;
+        }
+        ok = float_array_push(&source->vertices, vertex, 6);
+      }
+    }
+    else if (line[0] == 'f' && (line[1] == ' ' || line[1] == '\t'))
+    {
+      int vertexCount = (int)(source->vertices.count / 6);
+      int count = 0;
+      char* token = strtok(line + 2, " \t\r\n");
+
+      while (ok && token)
+      {
+        /* v, v/vt, v//vn or v/vt/vn; negative indices count back from the last vertex */
+        int index = atoi(token);
+        if (count == polygonCapacity)
+        {
+          int* grown;
+          polygonCapacity = polygonCapacity ? polygonCapacity * 2 : 16;
+          grown = (int*)realloc(polygon, sizeof(int) * polygonCapacity);
+          if (!grown)
+          {
+            ok = 0;
+            break;
+          }
+          polygon = grown;
+        }
+        polygon[count++] = index < 0 ? vertexCount + index : index - 1;
+        token = strtok(NULL, " \t\r\n");
+      }
+      if (ok)
+      {
+        ok = push_polygon(source, polygon, count);
+      }
+    }
+  }
+  free(polygon);
+  return ok;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PLY
+static PlyType ply_type(const char* name)
+{
+  static const struct { const char* name; PlyType type; } types[] = {
+    { "char", PLY_INT8 }, { "int8", PLY_INT8 }, { "uchar", PLY_UINT8 }, { "uint8", PLY_UINT8 },
+    { "short", PLY_INT16 }, { "int16", PLY_INT16 }, { "ushort", PLY_UINT16 }, { "uint16", PLY_UINT16 },
+    { "int", PLY_INT32 }, { "int32", PLY_INT32 }, { "uint", PLY_UINT32 }, { "uint32", PLY_UINT32 },
+    { "float", PLY_FLOAT32 }, { "float32", PLY_FLOAT32 }, { "double", PLY_FLOAT64 }, { "float64", PLY_FLOAT64 }
+  };
+  size_t i;
+  for (i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+  {
+    if (strcmp(name, types[i].name) == 0)
+    {
+      return types[i].type;
+    }
+  }
+  return PLY_NONE;
+}
+
+/*
+ * @ brief Read one scalar, ascii or binary little endian.
+ */
+static int ply_read(FILE* file, int binary, PlyType type, double* value)
+{
+  unsigned char bytes[8];
+  static const int sizes[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+
+  if (!binary)
+  {
+    return fscanf(file, "%lf", value) == 1;
+  }
+  if (fread(bytes, 1, sizes[type], file) != (size_t)sizes[type])
+  {
+    return 0;
+  }
+  switch (type)
+  {
+    case PLY_INT8: *value = (signed char)bytes[0]; break;
+    case PLY_UINT8: *value = bytes[0]; break;
+    case PLY_INT16: *value = (short)(bytes[0] | bytes[1] << 8); break;
+    case PLY_UINT16: *value = (unsigned short)(bytes[0] | bytes[1] << 8); break;
+    case PLY_INT32: *value = (int)((unsigned int)bytes[0] | (unsigned int)bytes[1] << 8 |
+                                   (unsigned int)bytes[2] << 16 | (unsigned int)bytes[3] << 24); break;
+    case PLY_UINT32: *value = (unsigned int)bytes[0] | (unsigned int)bytes[1] << 8 |
+                              (unsigned int)bytes[2] << 16 | (unsigned int)bytes[3] << 24; break;
+    case PLY_FLOAT32: { float f; memcpy(&f, bytes, 4); *value = f; break; }
+    case PLY_FLOAT64: memcpy(value, bytes, 8); break;
+    default: return 0;
+  }
+  return 1;
+}
+
+static int load_ply(FILE* file, SourceMesh* source)
+{
+  PlyElement elements[8];
+  int elementCount = 0;
+  int binary = -1;
+  char line[1024];
+  int e, p;
+  long i;
+
+  if (!fgets(line, sizeof(line), file) || strncmp(line, "ply", 3) != 0)
+  {
+    fprintf(stderr, "not a PLY file\n");
+    return 0;
+  }
+
+  /* Header */
+  while (fgets(line, sizeof(line), file))
+  {
+    char word[64], type[64], countType[64], name[64];
+
+    if (strncmp(line, "end_header", 10) == 0)
+    {
+      break;
+    }
+    if (sscanf(line, "format %63s", word) == 1)
+    {
+      binary = strcmp(word, "ascii") == 0 ? 0 : (strcmp(word, "binary_little_endian") == 0 ? 1 : -1);
+      if (binary < 0)
+      {
+        fprintf(stderr, "unsupported PLY format %s\n", word);
+        return 0;
+      }
+    }
+    else if (sscanf(line, "element %63s %ld", word, &i) == 2)
+    {
+      if (elementCount == (int)(sizeof(elements) / sizeof(elements[0])))
+      {
+        fprintf(stderr, "too many PLY elements\n");
+        return 0;
+      }
+      memset(&elements[elementCount], 0, sizeof(PlyElement));
+      strcpy(elements[elementCount].name, word);
+      elements[elementCount].count = i;
+      elementCount++;
+    }
+    else if (elementCount > 0 && sscanf(line, "property list %63s %63s %63s", countType, type, name) == 3)
+    {
+      PlyElement* element = &elements[elementCount - 1];
+      if (element->propertyCount == MAX_PLY_PROPERTIES)
+      {
+        return 0;
+      }
+      element->properties[element->propertyCount].countType = ply_type(countType);
+      element->properties[element->propertyCount].type = ply_type(type);
+      strcpy(element->properties[element->propertyCount].name, name);
+      element->propertyCount++;
+    }
+    else if (elementCount > 0 && sscanf(line, "property %63s %63s", type, name) == 2)
+    {
+      PlyElement* element = &elements[elementCount - 1];
+      if (element->propertyCount == MAX_PLY_PROPERTIES)
+      {
+        return 0;
+      }
+      element->properties[element->propertyCount].countType = PLY_NONE;
+      element->properties[element->propertyCount].type = ply_type(type);
+      strcpy(element->properties[element->propertyCount].name, name);
+      element->propertyCount++;
+    }
+  }
+  if (binary < 0)
+  {
+    fprintf(stderr, "missing PLY format\n");
+    return 0;
+  }
+  for (e = 0; e < elementCount; e++)
+  {
+    for (p = 0; p < elements[e].propertyCount; p++)
+    {
+      if (elements[e].properties[p].type == PLY_NONE)
+      {
+        fprintf(stderr, "unsupported PLY property type in %s\n", elements[e].name);
+        return 0;
+      }
+    }
+  }
+
+  /* Body, elements in header order */
+  for (e = 0; e < elementCount; e++)
+  {
+    PlyElement* element = &elements[e];
+    int isVertex = strcmp(element->name, "vertex") == 0;
+    int isFace = strcmp(element->name, "face") == 0;
+
+    for (i = 0; i < element->count; i++)
+    {
+      float vertex[6] = { 0.0f, 0.0f, 0.0f, DEFAULT_COLOR, DEFAULT_COLOR, DEFAULT_COLOR };
+      int polygon[64];
+      int polygonCount = 0;
+
+      for (p = 0; p < element->propertyCount; p++)
+      {
+        const PlyProperty* property = &element->properties[p];
+        double value;
+
+        if (property->countType != PLY_NONE)
+        {
+          double count;
+          long j;
+          int isIndices = isFace && (strcmp(property->name, "vertex_indices") == 0 ||
+                                     strcmp(property->name, "vertex_index") == 0);
+          if (!ply_read(file, binary, property->countType, &count) || count < 0)
+          {
+            return 0;
+          }
+          if (isIndices && count > (double)(sizeof(polygon) / sizeof(polygon[0])))
+          {
+            fprintf(stderr, "face with %ld vertices\n", (long)count);
+            return 0;
+          }
+          for (j = 0; j < (long)count; j++)
+          {
+            if (!ply_read(file, binary, property->type, &value))
+            {
+              return 0;
+            }
+            if (isIndices)
+            {
+              polygon[polygonCount++] = (int)value;
+            }
+          }
+          continue;
+        }
+
+        if (!ply_read(file, binary, property->type, &value))
+        {
+          return 0;
+        }
+        if (isVertex)
+        {
+          /* Integer colors are 0..255, float colors 0..1 */
+          double colorScale = (property->type == PLY_FLOAT32 || property->type == PLY_FLOAT64) ? 1.0 : 1.0 / 255.0;
+          if (strcmp(property->name, "x") == 0) vertex[0] = (float)value;
+          else if (strcmp(property->name, "y") == 0) vertex[1] = (float)value;
+          else if (strcmp(property->name, "z") == 0) vertex[2] = (float)value;
+          else if (strcmp(property->name, "red") == 0 || strcmp(property->name, "r") == 0) vertex[3] = (float)(value * colorScale);
+          else if (strcmp(property->name, "green") == 0 || strcmp(property->name, "g") == 0) vertex[4] = (float)(value * colorScale);
+          else if (strcmp(property->name, "blue") == 0 || strcmp(property->name, "b") == 0) vertex[5] = (float)(value * colorScale);
+        }
+      }
+
+      if (isVertex && !float_array_push(&source->vertices, vertex, 6))
+      {
+        return 0;
+      }
+      if (isFace && !push_polygon(source, polygon, polygonCount))
+      {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*
+ * @ brief Center the mesh at the origin and scale its largest extent to 1, the size of the cube.
+ */
+static void normalize_vertices(SourceMesh* source)
+{
+  float minimum[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+  float maximum[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+  float extent = 0.0f;
+  size_t i;
+  int axis;
+
+  for (i = 0; i < source->vertices.count; i += 6)
+  {
+    for (axis = 0; axis < 3; axis++)
+    {
+      float v = source->vertices.data[i + axis];
+      minimum[axis] = v < minimum[axis] ? v : minimum[axis];
+      maximum[axis] = v > maximum[axis] ? v : maximum[axis];
+    }
+  }
+  for (axis = 0; axis < 3; axis++)
+  {
+    extent = maximum[axis] - minimum[axis] > extent ? maximum[axis] - minimum[axis] : extent;
+  }
+  if (extent <= 0.0f)
+  {
+    return;
+  }
+  for (i = 0; i < source->vertices.count; i += 6)
+  {
+    for (axis = 0; axis < 3; axis++)
+    {
+      float center = (minimum[axis] + maximum[axis]) * 0.5f;
+      source->vertices.data[i + axis] = (source->vertices.data[i + axis] - center) / extent;
+    }
+  }
+}
+
+static void usage(const char* name)
+{
+  fprintf(stderr,
+          "Usage: %s [-f float|half] [-k] input.obj|input.ply output.mesh\n"
+          "  -f  position format (default half, use float for large or detailed models)\n"
+          "  -k  keep the model's coordinates, by default it is centered and scaled to the unit cube\n",
+          name);
+}
+
+int main(int argc, char** argv)
+{
+  SourceMesh source;
+  MeshFormat format = MESH_FORMAT_HALF_FLOAT;
+  int normalize = 1;
+  float* expanded;
+  Mesh mesh;
+  FILE* file;
+  const char* extension;
+  size_t i;
+  int opt, ok;
+
+  while ((opt = getopt(argc, argv, "f:k")) != -1)
+  {
+    switch (opt)
+    {
+      case 'f':
+        if (strcmp(optarg, "float") == 0)
+        {
+          format = MESH_FORMAT_FLOAT;
+        }
+        else if (strcmp(optarg, "half") == 0)
+        {
+          format = MESH_FORMAT_HALF_FLOAT;
+        }
+        else
+        {
+          usage(argv[0]);
+          return 2;
+        }
+        break;
+      case 'k': normalize = 0; break;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+  if (argc - optind != 2)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  file = fopen(argv[optind], "rb");
+  if (!file)
+  {
+    perror(argv[optind]);
+    return 1;
+  }
+  memset(&source, 0, sizeof(source));
+  extension = file_extension(argv[optind]);
+  if (strcasecmp(extension, "obj") == 0)
+  {
+    ok = load_obj(file, &source);
+  }
+  else if (strcasecmp(extension, "ply") == 0)
+  {
+    ok = load_ply(file, &source);
+  }
+  else
+  {
+    fprintf(stderr, "%s: unknown file type, expected .obj or .ply\n", argv[optind]);
+    ok = 0;
+  }
+  fclose(file);
+  if (!ok || source.triangleCount == 0 || source.triangleCount * 3 > 0x7fffffff)
+  {
+    fprintf(stderr, "%s: no usable triangles\n", argv[optind]);
+    return 1;
+  }
+
+  if (normalize)
+  {
+    normalize_vertices(&source);
+  }
+
+  /* Expand to a triangle list, mesh_create_indexed() shares what is identical once packed */
+  expanded = (float*)malloc(sizeof(float) * 6 * 3 * source.triangleCount);
+  if (!expanded)
+  {
+    return 1;
+  }
+  for (i = 0; i < source.triangleCount * 3; i++)
+  {
+    memcpy(expanded + i * 6, source.vertices.data + (size_t)source.triangles[i] * 6, sizeof(float) * 6);
+  }
+
+  ok = mesh_create_indexed(&mesh, expanded, (int)(source.triangleCount * 3), format) &&
+       mesh_write_file(&mesh, argv[optind + 1]);
+  if (ok)
+  {
+    printf("%s: %d vertices (%zu bytes), %d indices of %d bytes\n", argv[optind + 1], mesh.vertexCount,
+           mesh_vertex_bytes(&mesh), mesh.indexCount, mesh.indexSize);
+  }
+  else
+  {
+    fprintf(stderr, "%s: cannot write the mesh\n", argv[optind + 1]);
+  }
+
+  mesh_destroy(&mesh);
+  free(expanded);
+  free(source.vertices.data);
+  free(source.triangles);
+  return ok ? 0 : 1;
+}
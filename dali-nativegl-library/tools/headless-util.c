@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include "headless-util.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+static int has_extension(const char* extensions, const char* name);
+static EGLDisplay get_display(void);
+static int create_framebuffer(HeadlessContext* ctx);
+static int compare_samples(const void* a, const void* b);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+/*
+ * @ brief Check whether a space separated extension string contains name.
+ */
+static int has_extension(const char* extensions, const char* name)
+{
+  size_t length = strlen(name);
+  const char* p = extensions;
+
+  if (!extensions)
+  {
+    return 0;
+  }
+
+  while ((p = strstr(p, name)) != NULL)
+  {
+    if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+    {
+      return 1;
+    }
+    p += length;
+  }
+  return 0;
+}
+
+/*
+ * @ brief Prefer the Mesa surfaceless platform, it needs neither X11/Wayland nor a DRM node.
+ */
+static EGLDisplay get_display(void)
+{
+  const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+  if (has_extension(clientExtensions, "EGL_MESA_platform_surfaceless") &&
+      has_extension(clientExtensions, "EGL_EXT_platform_base"))
+  {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+    {
+      EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+      if (display != EGL_NO_DISPLAY)
+      {
+        return display;
+      }
+    }
+  }
+  return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+/*
+ * @ brief Render target for a surfaceless context, the library draws into framebuffer 0.
+ */
+static int create_framebuffer(HeadlessContext* ctx)
+{
+  glGenRenderbuffers(1, &ctx->colorRbo);
+  glBindRenderbuffer(GL_RENDERBUFFER, ctx->colorRbo);
+  /* RGBA8 is core in GLES3, GLES2 only guarantees RGB565 */
+  glRenderbufferStorage(GL_RENDERBUFFER, ctx->glesVersion >= 3 ? GL_RGBA8_OES : GL_RGB565, ctx->width, ctx->height);
+
+  glGenRenderbuffers(1, &ctx->depthRbo);
+  glBindRenderbuffer(GL_RENDERBUFFER, ctx->depthRbo);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, ctx->width, ctx->height);
+
+  glGenFramebuffers(1, &ctx->fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, ctx->fbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ctx->colorRbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, ctx->depthRbo);
+
+  return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+static int compare_samples(const void* a, const void* b)
+{
+  double da = *(const double*)a;
+  double db = *(const double*)b;
+  return (da > db) - (da < db);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int headless_context_create(HeadlessContext* ctx, int width, int height, int glesVersion)
+{
+  EGLint major, minor, count = 0;
+  EGLint renderable = glesVersion >= 3 ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_ES2_BIT;
+  EGLint configAttribs[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE, renderable,
+    EGL_RED_SIZE, 8,
+    EGL_GREEN_SIZE, 8,
+    EGL_BLUE_SIZE, 8,
+    EGL_DEPTH_SIZE, 16,
+    EGL_NONE
+  };
+  EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, glesVersion, EGL_NONE };
+  EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->width = width;
+  ctx->height = height;
+  ctx->glesVersion = glesVersion;
+  ctx->surface = EGL_NO_SURFACE;
+  ctx->context = EGL_NO_CONTEXT;
+
+  ctx->display = get_display();
+  if (ctx->display == EGL_NO_DISPLAY || !eglInitialize(ctx->display, &major, &minor))
+  {
+    fprintf(stderr, "headless: no EGL display\n");
+    return 0;
+  }
+  eglBindAPI(EGL_OPENGL_ES_API);
+
+  if (!eglChooseConfig(ctx->display, configAttribs, &ctx->config, 1, &count) || count == 0)
+  {
+    /* No pbuffer capable config, fall back to a surfaceless context rendering into an FBO */
+    configAttribs[1] = 0;
+    if (!eglChooseConfig(ctx->display, configAttribs, &ctx->config, 1, &count) || count == 0)
+    {
+      fprintf(stderr, "headless: no GLES%d config\n", glesVersion);
+      headless_context_destroy(ctx);
+      return 0;
+    }
+  }
+  else
+  {
+    ctx->surface = eglCreatePbufferSurface(ctx->display, ctx->config, surfaceAttribs);
+  }
+
+  ctx->context = eglCreateContext(ctx->display, ctx->config, EGL_NO_CONTEXT, contextAttribs);
+  if (ctx->context == EGL_NO_CONTEXT ||
+      !eglMakeCurrent(ctx->display, ctx->surface, ctx->surface, ctx->context))
+  {
+    fprintf(stderr, "headless: cannot make GLES%d context current (0x%x)\n", glesVersion, eglGetError());
+    headless_context_destroy(ctx);
+    return 0;
+  }
+
+  if (ctx->surface == EGL_NO_SURFACE && !create_framebuffer(ctx))
+  {
+    fprintf(stderr, "headless: incomplete offscreen framebuffer\n");
+    headless_context_destroy(ctx);
+    return 0;
+  }
+  return 1;
+}
+
+void headless_context_destroy(HeadlessContext* ctx)
+{
+  if (ctx->display == EGL_NO_DISPLAY)
+  {
+    return;
+  }
+
+  if (ctx->fbo)
+  {
+    glDeleteFramebuffers(1, &ctx->fbo);
+    glDeleteRenderbuffers(1, &ctx->colorRbo);
+    glDeleteRenderbuffers(1, &ctx->depthRbo);
+  }
+  eglMakeCurrent(ctx->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (ctx->context != EGL_NO_CONTEXT)
+  {
+    eglDestroyContext(ctx->display, ctx->context);
+  }
+  if (ctx->surface != EGL_NO_SURFACE)
+  {
+    eglDestroySurface(ctx->display, ctx->surface);
+  }
+  eglTerminate(ctx->display);
+  memset(ctx, 0, sizeof(*ctx));
+}
+
+int headless_context_replace(HeadlessContext* ctx)
+{
+  EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, ctx->glesVersion, EGL_NONE };
+
+  /* The render target of a surfaceless context goes with it */
+  eglMakeCurrent(ctx->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  eglDestroyContext(ctx->display, ctx->context);
+  ctx->fbo = 0;
+  ctx->colorRbo = 0;
+  ctx->depthRbo = 0;
+
+  ctx->context = eglCreateContext(ctx->display, ctx->config, EGL_NO_CONTEXT, contextAttribs);
+  if (ctx->context == EGL_NO_CONTEXT ||
+      !eglMakeCurrent(ctx->display, ctx->surface, ctx->surface, ctx->context))
+  {
+    fprintf(stderr, "headless: cannot make a new GLES%d context current (0x%x)\n", ctx->glesVersion, eglGetError());
+    return 0;
+  }
+  if (ctx->surface == EGL_NO_SURFACE && !create_framebuffer(ctx))
+  {
+    fprintf(stderr, "headless: incomplete offscreen framebuffer\n");
+    return 0;
+  }
+  return 1;
+}
+
+double headless_time_now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+double headless_thread_cpu_time_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+void headless_sort_samples(double* samples, int count)
+{
+  qsort(samples, count, sizeof(double), compare_samples);
+}
+
+double headless_percentile(const double* sorted, int count, double p)
+{
+  int rank;
+
+  if (count <= 0)
+  {
+    return 0.0;
+  }
+
+  rank = (int)(p / 100.0 * count + 0.999999);
+  if (rank < 1)
+  {
+    rank = 1;
+  }
+  if (rank > count)
+  {
+    rank = count;
+  }
+  return sorted[rank - 1];
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2011-2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DALI_NATIVEGL_HEADLESS_UTIL_H__
+#define __DALI_NATIVEGL_HEADLESS_UTIL_H__
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Offscreen EGL context used in place of the DALi/NUI GlWindow */
+typedef struct {
+    EGLDisplay display;
+    EGLConfig  config;
+    EGLContext context;
+    EGLSurface surface;
+
+    /* Only used when no pbuffer could be created (surfaceless context) */
+    GLuint fbo;
+    GLuint colorRbo;
+    GLuint depthRbo;
+
+    int width;
+    int height;
+    int glesVersion;
+} HeadlessContext;
+
+/*
+ * @ brief Create an offscreen GLES context and make it current.
+ * @ param[in] ctx          The context to fill in.
+ * @ param[in] width,height Size of the offscreen render target.
+ * @ param[in] glesVersion  Requested GLES major version (2 or 3).
+ * @ return 1 on success, 0 on failure.
+ */
+int headless_context_create(HeadlessContext* ctx, int width, int height, int glesVersion);
+
+/*
+ * @ brief Release the offscreen context and its render target.
+ */
+void headless_context_destroy(HeadlessContext* ctx);
+
+/*
+ * @ brief Destroy the context with all its objects and make a new one current on the same
+ *         display and surface, as an application does after losing its context.
+ * @ return 1 on success, 0 on failure.
+ */
+int headless_context_replace(HeadlessContext* ctx);
+
+/*
+ * @ brief Monotonic clock in milliseconds.
+ */
+double headless_time_now_ms(void);
+
+/*
+ * @ brief CPU time consumed by the calling thread in milliseconds.
+ */
+double headless_thread_cpu_time_ms(void);
+
+/*
+ * @ brief Sort samples in ascending order.
+ */
+void headless_sort_samples(double* samples, int count);
+
+/*
+ * @ brief Nearest-rank percentile of sorted samples.
+ * @ param[in] sorted Samples sorted by headless_sort_samples().
+ * @ param[in] count  Number of samples.
+ * @ param[in] p      Percentile in the range [0, 100].
+ */
+double headless_percentile(const double* sorted, int count, double p);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DALI_NATIVEGL_HEADLESS_UTIL_H__ */